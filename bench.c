@@ -0,0 +1,298 @@
+#include "c_list.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * c_list_bench [--json] [--max-size N] [--max-bytes B]
+ *
+ * Times every core operation against a plain malloc/realloc array doing the
+ * same work, for list sizes 10, 100, ... up to --max-size (default 10^6,
+ * at most 10^8). Sizes whose data would exceed --max-bytes (default 1 GiB)
+ * are skipped. Output is CSV on stdout unless --json is given.
+ */
+
+LIST_INIT
+
+typedef struct {
+    uint64_t v[8];
+} Blob64;
+
+#define BLOB_EQ(a, b) (memcmp(&(a), &(b), sizeof(Blob64)) == 0)
+
+ListDec(int, IntList)
+
+ListDef(int, IntList)
+
+ListDec(float, FloatList)
+
+ListDef(float, FloatList)
+
+ListDec(Blob64, BlobList)
+
+ListDefWithEq(Blob64, BlobList, BLOB_EQ)
+
+static bool json_output = false;
+static bool first_record = true;
+static volatile uint64_t sink;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void report(const char *op, const char *element, size_t element_size, size_t size,
+                   const char *impl, size_t ops, uint64_t elapsed_ns) {
+    double ns_per_op = ops ? (double)elapsed_ns / (double)ops : 0.0;
+    if (json_output) {
+        printf("%s\n  {\"op\": \"%s\", \"element\": \"%s\", \"element_size\": %zu, \"size\": %zu, "
+               "\"impl\": \"%s\", \"ops\": %zu, \"ns_per_op\": %.3f}",
+               first_record ? "[" : ",", op, element, element_size, size, impl, ops, ns_per_op);
+    } else {
+        if (first_record) {
+            printf("op,element,element_size,size,impl,ops,ns_per_op\n");
+        }
+        printf("%s,%s,%zu,%zu,%s,%zu,%.3f\n", op, element, element_size, size, impl, ops, ns_per_op);
+    }
+    first_record = false;
+    fflush(stdout);
+}
+
+/* Repeat O(n) operations enough times to get a stable reading on small sizes. */
+static size_t rounds_for(size_t n, size_t budget) {
+    size_t rounds = budget / (n ? n : 1);
+    return rounds ? rounds : 1;
+}
+
+#define INT_MAKE(i) ((int)(i))
+#define INT_KEY(x) ((uint64_t)(x))
+#define INT_ABSENT (-1)
+
+#define FLOAT_MAKE(i) ((float)(i))
+#define FLOAT_KEY(x) ((uint64_t)(x))
+#define FLOAT_ABSENT (-1.0f)
+
+static Blob64 blob_make(size_t i) {
+    Blob64 blob = {{0}};
+    blob.v[0] = (uint64_t)i;
+    return blob;
+}
+
+#define BLOB_MAKE(i) blob_make(i)
+#define BLOB_KEY(x) ((x).v[0])
+#define BLOB_ABSENT blob_make(SIZE_MAX)
+
+#define TIME_OP(op, impl, ops, body) \
+    do { \
+        uint64_t start_ = now_ns(); \
+        body; \
+        report(op, label, element_size, n, impl, (ops), now_ns() - start_); \
+    } while (0)
+
+#define BENCH_SUITE(type, list_name, label_text, MAKE, KEY, ABSENT, EQ) \
+    static void bench_##list_name(size_t n) { \
+        const char *label = label_text; \
+        size_t element_size = sizeof(type); \
+        type absent = ABSENT; \
+        type present = MAKE(n / 2); \
+        list_name *list = NULL; \
+        type *raw = NULL; \
+        type *arr = malloc(n * sizeof(type)); \
+        if (arr == NULL) { \
+            goto out_of_memory; \
+        } \
+        for (size_t i = 0; i < n; i++) { \
+            arr[i] = MAKE(i); \
+        } \
+ \
+        /* push / pop */ \
+        list = create_##list_name(); \
+        if (list == NULL) { \
+            goto out_of_memory; \
+        } \
+        TIME_OP("push", "c_list", n, \
+                for (size_t i = 0; i < n; i++) push_##list_name(list, arr[i])); \
+        TIME_OP("pop", "c_list", n, \
+                for (size_t i = 0; i < n; i++) sink += KEY(pop_##list_name(list))); \
+        destroy_##list_name(list); \
+        list = NULL; \
+ \
+        size_t raw_count = 0, raw_capacity = 0; \
+        TIME_OP("push", "array", n, \
+                for (size_t i = 0; i < n; i++) { \
+                    if (raw_count == raw_capacity) { \
+                        raw_capacity = raw_capacity ? raw_capacity * 2 : 8; \
+                        type *grown = realloc(raw, raw_capacity * sizeof(type)); \
+                        if (grown == NULL) { \
+                            goto out_of_memory; \
+                        } \
+                        raw = grown; \
+                    } \
+                    raw[raw_count++] = arr[i]; \
+                }); \
+        TIME_OP("pop", "array", n, \
+                for (size_t i = 0; i < n; i++) sink += KEY(raw[--raw_count])); \
+        free(raw); \
+        raw = NULL; \
+ \
+        /* insert / remove_at in the middle of an n-element list */ \
+        size_t shifts = rounds_for(n, 10000000); \
+        if (shifts > 1000) { \
+            shifts = 1000; \
+        } \
+        list = from_array_##list_name(arr, n); \
+        if (list == NULL) { \
+            goto out_of_memory; \
+        } \
+        TIME_OP("insert", "c_list", shifts, \
+                for (size_t i = 0; i < shifts; i++) insert_##list_name(list, n / 2, arr[i % n])); \
+        TIME_OP("remove_at", "c_list", shifts, \
+                for (size_t i = 0; i < shifts; i++) remove_at_##list_name(list, n / 2)); \
+ \
+        raw = malloc((n + shifts) * sizeof(type)); \
+        if (raw == NULL) { \
+            goto out_of_memory; \
+        } \
+        memcpy(raw, arr, n * sizeof(type)); \
+        raw_count = n; \
+        TIME_OP("insert", "array", shifts, \
+                for (size_t i = 0; i < shifts; i++) { \
+                    memmove(raw + n / 2 + 1, raw + n / 2, (raw_count - n / 2) * sizeof(type)); \
+                    raw[n / 2] = arr[i % n]; \
+                    raw_count++; \
+                }); \
+        TIME_OP("remove_at", "array", shifts, \
+                for (size_t i = 0; i < shifts; i++) { \
+                    memmove(raw + n / 2, raw + n / 2 + 1, (raw_count - n / 2 - 1) * sizeof(type)); \
+                    raw_count--; \
+                }); \
+ \
+        /* find: needle absent, full scan */ \
+        size_t scans = rounds_for(n, 50000000); \
+        TIME_OP("find", "c_list", scans, \
+                for (size_t r = 0; r < scans; r++) sink += (uint64_t)find_##list_name(list, absent)); \
+        TIME_OP("find", "array", scans, \
+                for (size_t r = 0; r < scans; r++) { \
+                    size_t found = SIZE_MAX; \
+                    for (size_t i = 0; i < raw_count; i++) { \
+                        if (EQ(raw[i], absent)) { \
+                            found = i; \
+                            break; \
+                        } \
+                    } \
+                    sink += found; \
+                }); \
+ \
+        /* count: needle present once, full scan */ \
+        TIME_OP("count", "c_list", scans, \
+                for (size_t r = 0; r < scans; r++) sink += (uint64_t)count_##list_name(list, present)); \
+        TIME_OP("count", "array", scans, \
+                for (size_t r = 0; r < scans; r++) { \
+                    size_t matches = 0; \
+                    for (size_t i = 0; i < raw_count; i++) { \
+                        if (EQ(raw[i], present)) { \
+                            matches++; \
+                        } \
+                    } \
+                    sink += matches; \
+                }); \
+        free(raw); \
+        raw = NULL; \
+ \
+        /* extend / sublist / from_array: whole-list copies */ \
+        size_t copies = rounds_for(n, 10000000); \
+        TIME_OP("extend", "c_list", copies, \
+                for (size_t r = 0; r < copies; r++) { \
+                    list_name *dst = create_##list_name(); \
+                    if (dst == NULL) { \
+                        goto out_of_memory; \
+                    } \
+                    extend_##list_name(dst, list); \
+                    sink += (uint64_t)dst->count; \
+                    destroy_##list_name(dst); \
+                }); \
+        TIME_OP("sublist", "c_list", copies, \
+                for (size_t r = 0; r < copies; r++) { \
+                    list_name *dst = sublist_##list_name(list, 0, n); \
+                    if (dst == NULL) { \
+                        goto out_of_memory; \
+                    } \
+                    sink += (uint64_t)dst->count; \
+                    destroy_##list_name(dst); \
+                }); \
+        TIME_OP("from_array", "c_list", copies, \
+                for (size_t r = 0; r < copies; r++) { \
+                    list_name *dst = from_array_##list_name(arr, n); \
+                    if (dst == NULL) { \
+                        goto out_of_memory; \
+                    } \
+                    sink += (uint64_t)dst->count; \
+                    destroy_##list_name(dst); \
+                }); \
+        TIME_OP("copy", "array", copies, \
+                for (size_t r = 0; r < copies; r++) { \
+                    type *dst = malloc(n * sizeof(type)); \
+                    if (dst == NULL) { \
+                        goto out_of_memory; \
+                    } \
+                    memcpy(dst, arr, n * sizeof(type)); \
+                    sink += KEY(dst[n - 1]); \
+                    free(dst); \
+                }); \
+ \
+        destroy_##list_name(list); \
+        free(arr); \
+        return; \
+ \
+    out_of_memory: \
+        fprintf(stderr, "skipping %s/%zu: out of memory\n", label, n); \
+        if (list != NULL) { \
+            destroy_##list_name(list); \
+        } \
+        free(raw); \
+        free(arr); \
+    }
+
+BENCH_SUITE(int, IntList, "int", INT_MAKE, INT_KEY, INT_ABSENT, LIST_EQ)
+
+BENCH_SUITE(float, FloatList, "float", FLOAT_MAKE, FLOAT_KEY, FLOAT_ABSENT, LIST_EQ)
+
+BENCH_SUITE(Blob64, BlobList, "blob64", BLOB_MAKE, BLOB_KEY, BLOB_ABSENT, BLOB_EQ)
+
+int main(int argc, char **argv) {
+    size_t max_size = 1000000;
+    size_t max_bytes = (size_t)1 << 30;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json_output = true;
+        } else if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            max_size = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-bytes") == 0 && i + 1 < argc) {
+            max_bytes = strtoull(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "usage: %s [--json] [--max-size N] [--max-bytes B]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (max_size > 100000000) {
+        max_size = 100000000;
+    }
+
+    for (size_t n = 10; n <= max_size; n *= 10) {
+        if (n * sizeof(int) <= max_bytes) {
+            bench_IntList(n);
+        }
+        if (n * sizeof(float) <= max_bytes) {
+            bench_FloatList(n);
+        }
+        if (n * sizeof(Blob64) <= max_bytes) {
+            bench_BlobList(n);
+        }
+    }
+    if (json_output) {
+        printf("%s\n", first_record ? "[]" : "\n]");
+    }
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -23,6 +24,12 @@
 #define FREE_ARRAY(type, pointer, oldCount) \
     reallocate(pointer, sizeof(type) * (oldCount), 0)
 
+#define CHANGE_ARRAY_WITH(allocator, type, pointer, oldCount, newCount) \
+    (type *)list_reallocate(allocator, pointer, sizeof(type) * (oldCount), sizeof(type) * (newCount))
+
+#define FREE_ARRAY_WITH(allocator, type, pointer, oldCount) \
+    list_reallocate(allocator, pointer, sizeof(type) * (oldCount), 0)
+
 #define log_err(M, ...)                                                       \
     fprintf(stderr, "[ERROR] (%s::%d::%s: errno: %s) " M "\n",                \
     __FILE__, __LINE__, __func__, clean_list_errno(), ##__VA_ARGS__)
@@ -35,6 +42,222 @@ static inline void *reallocate(void *pointer, size_t oldSize, size_t newSize) {
     return realloc(pointer, newSize);
 }
 
+/*
+ * User supplied allocator. `reallocate` follows the same contract as the
+ * built-in reallocate(): newSize == 0 frees, pointer == NULL allocates.
+ */
+typedef struct {
+    void *(*reallocate)(void *ctx, void *pointer, size_t oldSize, size_t newSize);
+    void *ctx;
+} List_allocator;
+
+static inline void *list_reallocate(const List_allocator *allocator, void *pointer, size_t oldSize, size_t newSize) {
+    if (allocator == NULL) {
+        return reallocate(pointer, oldSize, newSize);
+    }
+    return allocator->reallocate(allocator->ctx, pointer, oldSize, newSize);
+}
+
+/*
+ * Bump allocator: allocations are carved out of large blocks and only
+ * released all at once by list_arena_reset() / list_arena_destroy().
+ * Growing or freeing the most recent allocation is done in place.
+ */
+#define LIST_ARENA_ALIGN _Alignof(max_align_t)
+
+#define LIST_ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+typedef struct List_arena_block {
+    struct List_arena_block *prev;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+} List_arena_block;
+
+typedef struct {
+    List_arena_block *head;
+    size_t block_size;
+    void *last;
+    List_allocator allocator;
+} List_arena;
+
+static inline size_t list_arena_align(size_t size) {
+    return (size + LIST_ARENA_ALIGN - 1) & ~(size_t)(LIST_ARENA_ALIGN - 1);
+}
+
+static inline void *list_arena_alloc(List_arena *arena, size_t size) {
+    size = list_arena_align(size);
+    List_arena_block *block = arena->head;
+    if (block == NULL || block->size - block->used < size) {
+        size_t block_size = size > arena->block_size ? size : arena->block_size;
+        block = (List_arena_block *)malloc(sizeof(List_arena_block) + block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->prev = arena->head;
+        block->size = block_size;
+        block->used = 0;
+        arena->head = block;
+    }
+    void *pointer = (char *)block->data + block->used;
+    block->used += size;
+    arena->last = pointer;
+    return pointer;
+}
+
+static inline void *list_arena_reallocate(void *ctx, void *pointer, size_t oldSize, size_t newSize) {
+    List_arena *arena = (List_arena *)ctx;
+    if (pointer != NULL && pointer == arena->last) {
+        List_arena_block *block = arena->head;
+        size_t offset = (size_t)((char *)pointer - (char *)block->data);
+        if (newSize == 0) {
+            block->used = offset;
+            arena->last = NULL;
+            return NULL;
+        }
+        if (block->size - offset >= list_arena_align(newSize)) {
+            block->used = offset + list_arena_align(newSize);
+            return pointer;
+        }
+    }
+    if (newSize == 0) {
+        return NULL;
+    }
+    void *result = list_arena_alloc(arena, newSize);
+    if (result != NULL && pointer != NULL) {
+        memcpy(result, pointer, oldSize < newSize ? oldSize : newSize);
+    }
+    return result;
+}
+
+static inline void list_arena_init(List_arena *arena, size_t block_size) {
+    arena->head = NULL;
+    arena->block_size = block_size == 0 ? LIST_ARENA_DEFAULT_BLOCK_SIZE : block_size;
+    arena->last = NULL;
+    arena->allocator.reallocate = list_arena_reallocate;
+    arena->allocator.ctx = arena;
+}
+
+/* Releases every allocation at once, keeping the newest block for reuse. */
+static inline void list_arena_reset(List_arena *arena) {
+    List_arena_block *block = arena->head;
+    if (block == NULL) {
+        return;
+    }
+    while (block->prev != NULL) {
+        List_arena_block *prev = block->prev;
+        block->prev = prev->prev;
+        free(prev);
+    }
+    block->used = 0;
+    arena->last = NULL;
+}
+
+static inline void list_arena_destroy(List_arena *arena) {
+    while (arena->head != NULL) {
+        List_arena_block *prev = arena->head->prev;
+        free(arena->head);
+        arena->head = prev;
+    }
+    arena->last = NULL;
+}
+
+static inline List_allocator *list_arena_allocator(List_arena *arena) {
+    return &arena->allocator;
+}
+
+/*
+ * Growth helpers working on size_t; both return 0 when the result would
+ * exceed max_capacity, so callers can report the overflow instead of wrapping.
+ */
+static inline size_t list_grow_capacity(size_t capacity, size_t max_capacity) {
+    if (capacity >= max_capacity) {
+        return 0;
+    }
+    if (capacity < 8) {
+        return max_capacity < 8 ? max_capacity : 8;
+    }
+    return capacity > max_capacity / 2 ? max_capacity : capacity * 2;
+}
+
+static inline size_t list_next_power_of_2(size_t a, size_t max_capacity) {
+    if (a > max_capacity) {
+        return 0;
+    }
+    size_t begin = 16;
+    while (begin < a) {
+        if (begin > max_capacity / 2) {
+            return max_capacity;
+        }
+        begin *= 2;
+    }
+    return begin < max_capacity ? begin : max_capacity;
+}
+
+static inline size_t list_capacity_limit(size_t max_count, size_t element_size) {
+    size_t limit = SIZE_MAX / element_size;
+    return max_count < limit ? max_count : limit;
+}
+
+/*
+ * Growth/shrink policy. Capacity grows by grow_num / grow_den (at least by
+ * one element) starting from min_capacity, and is halved whenever
+ * count * shrink_ratio < capacity; shrink_ratio == 0 disables auto-shrink.
+ * Shrinking never goes below the element count, and grow_den == 0 is read
+ * as 1. A NULL policy is the default: x2 from 8, shrink below a quarter.
+ */
+typedef struct {
+    size_t min_capacity;
+    unsigned grow_num;
+    unsigned grow_den;
+    unsigned shrink_ratio;
+} List_policy;
+
+static inline size_t list_policy_grow(const List_policy *policy, size_t capacity, size_t max_capacity) {
+    if (policy == NULL) {
+        return list_grow_capacity(capacity, max_capacity);
+    }
+    if (capacity >= max_capacity) {
+        return 0;
+    }
+    if (capacity < policy->min_capacity) {
+        return policy->min_capacity < max_capacity ? policy->min_capacity : max_capacity;
+    }
+    size_t den = policy->grow_den ? policy->grow_den : 1;
+    size_t factor = policy->grow_num > den ? policy->grow_num - den : 0;
+    size_t step = capacity / den * factor + capacity % den * factor / den;
+    if (step == 0) {
+        step = 1;
+    }
+    return capacity > max_capacity - step ? max_capacity : capacity + step;
+}
+
+static inline bool list_policy_should_shrink(const List_policy *policy, size_t count, size_t capacity) {
+    if (policy == NULL) {
+        return count < capacity / 4;
+    }
+    return policy->shrink_ratio != 0 && count < capacity / policy->shrink_ratio;
+}
+
+/* Halved capacity, never below min_capacity or count. */
+static inline size_t list_policy_shrink(const List_policy *policy, size_t count, size_t capacity) {
+    size_t smaller = policy == NULL ? DECREASE_CAPACITY(capacity)
+                     : capacity / 2 < policy->min_capacity ? policy->min_capacity : capacity / 2;
+    return smaller < count ? count : smaller;
+}
+
+/* Capacity after shrinking to fit `count`, one decision instead of halving repeatedly. */
+static inline size_t list_policy_shrink_target(const List_policy *policy, size_t count, size_t capacity) {
+    while (list_policy_should_shrink(policy, count, capacity)) {
+        size_t smaller = list_policy_shrink(policy, count, capacity);
+        if (smaller >= capacity) {
+            break;
+        }
+        capacity = smaller;
+    }
+    return capacity;
+}
+
 static inline int next_power_of_2(const int a) {
     if (a == INT_MAX) {
         return INT_MAX;
@@ -55,9 +278,28 @@ typedef enum {
     LIST_INVALID_PRINTFN,
     LIST_INVALID_CAPACITY,
     LIST_INVALID_RAW_ARRAY,
+    LIST_IO_ERROR,
+    LIST_INVALID_FORMAT,
 } List_errno;
 
-extern List_errno global_list_errno;
+/*
+ * The global error code is per thread, so lists owned by different threads
+ * never share it. C_LIST_NO_GLOBAL_ERRNO stops list operations from writing
+ * it at all; C_LIST_NO_ERRNO additionally skips the per-list error code.
+ */
+#if defined(C_LIST_NO_THREAD_LOCAL)
+#define LIST_THREAD_LOCAL
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define LIST_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define LIST_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define LIST_THREAD_LOCAL __declspec(thread)
+#else
+#define LIST_THREAD_LOCAL
+#endif
+
+extern LIST_THREAD_LOCAL List_errno global_list_errno;
 
 extern const char *List_errno_string[];
 
@@ -72,7 +314,20 @@ static inline List_errno get_list_errno() {
 }
 
 static inline void set_list_errno(List_errno e) {
+#if !defined(C_LIST_NO_GLOBAL_ERRNO) && !defined(C_LIST_NO_ERRNO)
     global_list_errno = e;
+#else
+    (void)e;
+#endif
+}
+
+static inline void list_store_errno(List_errno *err, List_errno e) {
+#ifndef C_LIST_NO_ERRNO
+    *err = e;
+#else
+    (void)err;
+#endif
+    set_list_errno(e);
 }
 
 static inline const char *clean_list_errno() {
@@ -80,7 +335,7 @@ static inline const char *clean_list_errno() {
 }
 
 #define LIST_INIT \
-    List_errno global_list_errno = LIST_OK;          \
+    LIST_THREAD_LOCAL List_errno global_list_errno = LIST_OK; \
     const char *List_errno_string[] = {              \
         "LIST_OK" ,                                  \
         "LIST_NOT_EXIST",                            \
@@ -89,84 +344,498 @@ static inline const char *clean_list_errno() {
         "LIST_ALLOCATION_FAILED",                    \
         "LIST_INVALID_PRINTFN",                      \
         "LIST_INVALID_CAPACITY",                     \
+        "LIST_INVALID_RAW_ARRAY",                    \
+        "LIST_IO_ERROR",                             \
+        "LIST_INVALID_FORMAT",                       \
+};                                                   \
+LIST_INIT_PARALLEL_
+
+/*
+ * Vectorized equality scans used by find_, count_, replace_ and remove_ when
+ * the element type is a built-in integer or floating point type. SSE2 is the
+ * x86-64 baseline; AVX2 is selected at run time when the CPU supports it.
+ * Define C_LIST_NO_SIMD to always use the scalar loops.
+ */
+enum {
+    LIST_SIMD_NONE = 0,
+    LIST_SIMD_INT,
+    LIST_SIMD_FLOAT,
 };
 
-#define ListDec(type, list_name)                                                            \
-    typedef struct                                                                          \
-    {                                                                                       \
-        int capacity;                                                                       \
-        int count;                                                                          \
-        type *data;                                                                         \
-        List_errno err;                                                                     \
-    } list_name;                                                                            \
-    type list_name##_default_element;                                                       \
-                                                                                            \
-    List_errno get_errno_##list_name(list_name *list);                                      \
-    void set_errno_##list_name(list_name *list, List_errno e);                              \
-    list_name *create_##list_name();                                                        \
-    void destroy_##list_name(list_name *list);                                              \
-    void init_##list_name(list_name *list);                                                 \
-    bool push_##list_name(list_name *list, type Element);                                   \
-    type pop_##list_name(list_name *list);                                                  \
-    bool resize_##list_name(list_name *list, int new_capacity);                             \
-    bool expand_##list_name(list_name *list);                                               \
-    bool shrink_##list_name(list_name *list);                                               \
-    type first_##list_name(list_name *list);                                                \
-    type back_##list_name(list_name *list);                                                 \
-    type get_##list_name(list_name *list, size_t index);                                    \
-    bool set_##list_name(list_name *list, size_t index, type Element);                      \
-    int find_##list_name(list_name *list, type Element);                                    \
-    void free_##list_name(list_name *list);                                                 \
-    int size_##list_name(list_name *list);                                                  \
-    int capacity_##list_name(list_name *list);                                              \
-    bool empty_##list_name(list_name *list);                                                \
-    void clear_##list_name(list_name *list);                                                \
-    list_name *extend_##list_name(list_name *list_a, list_name *list_b);                    \
-    bool insert_##list_name(list_name *list, size_t index, type Element);                   \
-    bool remove_at_##list_name(list_name *list, size_t index);                              \
-    void remove_##list_name(list_name *list, type Element);                                 \
-    list_name *sublist_##list_name(list_name *list, size_t start, size_t end);              \
-    void replace_##list_name(list_name *list, type oldElement, type newElement);            \
-    void print_##list_name(list_name *list, void (*printElement)(type));                    \
-    list_name *from_array_##list_name(type *arr, size_t len);                               \
-    type *to_array_##list_name(list_name *list);
-
-
-#define ListDef(type, list_name)                                                               \
-    List_errno get_errno_##list_name(list_name *list){                                         \
+#define LIST_SIMD_UNSUPPORTED SIZE_MAX
+
+#define LIST_SIMD_KIND(x) _Generic((x),                          \
+    _Bool: LIST_SIMD_INT, char: LIST_SIMD_INT,                   \
+    signed char: LIST_SIMD_INT, unsigned char: LIST_SIMD_INT,    \
+    short: LIST_SIMD_INT, unsigned short: LIST_SIMD_INT,         \
+    int: LIST_SIMD_INT, unsigned int: LIST_SIMD_INT,             \
+    long: LIST_SIMD_INT, unsigned long: LIST_SIMD_INT,           \
+    long long: LIST_SIMD_INT, unsigned long long: LIST_SIMD_INT, \
+    float: LIST_SIMD_FLOAT, double: LIST_SIMD_FLOAT,             \
+    default: LIST_SIMD_NONE)
+
+#if !defined(C_LIST_NO_SIMD) && defined(__GNUC__) && defined(__SSE2__)
+#define LIST_SIMD 1
+#include <immintrin.h>
+
+typedef uint8_t list_simd_u8 __attribute__((may_alias));
+typedef uint16_t list_simd_u16 __attribute__((may_alias));
+typedef uint32_t list_simd_u32 __attribute__((may_alias));
+typedef uint64_t list_simd_u64 __attribute__((may_alias));
+typedef float list_simd_f32 __attribute__((may_alias));
+typedef double list_simd_f64 __attribute__((may_alias));
+
+#define LIST_SIMD_KERNELS_(isa, attr, vec, LOADU, STOREU, MOVEMASK, AND, ANDNOT, OR, suffix, ctype, SET1, CMPEQ)       \
+    static inline attr size_t list_find_##isa##_##suffix(const ctype *data, size_t n, ctype value) {                   \
+        const size_t lanes = sizeof(vec) / sizeof(ctype);                                                              \
+        const vec needle = SET1(value);                                                                                \
+        size_t i = 0;                                                                                                  \
+        for (; i + lanes <= n; i += lanes) {                                                                           \
+            unsigned mask = (unsigned)MOVEMASK(CMPEQ(LOADU((const vec *)(data + i)), needle));                         \
+            if (mask != 0) {                                                                                           \
+                return i + (size_t)__builtin_ctz(mask) / sizeof(ctype);                                                \
+            }                                                                                                          \
+        }                                                                                                              \
+        for (; i < n; i++) {                                                                                           \
+            if (data[i] == value) {                                                                                    \
+                return i;                                                                                              \
+            }                                                                                                          \
+        }                                                                                                              \
+        return n;                                                                                                      \
+    }                                                                                                                  \
+                                                                                                                       \
+    static inline attr size_t list_count_##isa##_##suffix(const ctype *data, size_t n, ctype value) {                  \
+        const size_t lanes = sizeof(vec) / sizeof(ctype);                                                              \
+        const vec needle = SET1(value);                                                                                \
+        size_t i = 0, count = 0;                                                                                       \
+        for (; i + lanes <= n; i += lanes) {                                                                           \
+            unsigned mask = (unsigned)MOVEMASK(CMPEQ(LOADU((const vec *)(data + i)), needle));                         \
+            count += (size_t)__builtin_popcount(mask);                                                                 \
+        }                                                                                                              \
+        count /= sizeof(ctype);                                                                                        \
+        for (; i < n; i++) {                                                                                           \
+            count += data[i] == value;                                                                                 \
+        }                                                                                                              \
+        return count;                                                                                                  \
+    }                                                                                                                  \
+                                                                                                                       \
+    static inline attr size_t list_replace_##isa##_##suffix(ctype *data, size_t n, ctype old_value, ctype new_value) { \
+        const size_t lanes = sizeof(vec) / sizeof(ctype);                                                              \
+        const vec needle = SET1(old_value);                                                                            \
+        const vec replacement = SET1(new_value);                                                                       \
+        size_t i = 0, count = 0;                                                                                       \
+        for (; i + lanes <= n; i += lanes) {                                                                           \
+            vec v = LOADU((const vec *)(data + i));                                                                    \
+            vec hit = CMPEQ(v, needle);                                                                                \
+            unsigned mask = (unsigned)MOVEMASK(hit);                                                                   \
+            if (mask != 0) {                                                                                           \
+                STOREU((vec *)(data + i), OR(AND(hit, replacement), ANDNOT(hit, v)));                                  \
+                count += (size_t)__builtin_popcount(mask);                                                             \
+            }                                                                                                          \
+        }                                                                                                              \
+        count /= sizeof(ctype);                                                                                        \
+        for (; i < n; i++) {                                                                                           \
+            if (data[i] == old_value) {                                                                                \
+                data[i] = new_value;                                                                                   \
+                count++;                                                                                               \
+            }                                                                                                          \
+        }                                                                                                              \
+        return count;                                                                                                  \
+    }
+
+#define LIST_SSE2_KERNELS_(suffix, ctype, SET1, CMPEQ)                                        \
+    LIST_SIMD_KERNELS_(sse2, , __m128i, _mm_loadu_si128, _mm_storeu_si128, _mm_movemask_epi8, \
+                       _mm_and_si128, _mm_andnot_si128, _mm_or_si128, suffix, ctype, SET1, CMPEQ)
+
+static inline __m128i list_sse2_set1_u8(uint8_t v) { return _mm_set1_epi8((char)v); }
+static inline __m128i list_sse2_set1_u16(uint16_t v) { return _mm_set1_epi16((short)v); }
+static inline __m128i list_sse2_set1_u32(uint32_t v) { return _mm_set1_epi32((int)v); }
+static inline __m128i list_sse2_set1_u64(uint64_t v) { return _mm_set1_epi64x((long long)v); }
+static inline __m128i list_sse2_set1_f32(float v) { return _mm_castps_si128(_mm_set1_ps(v)); }
+static inline __m128i list_sse2_set1_f64(double v) { return _mm_castpd_si128(_mm_set1_pd(v)); }
+
+static inline __m128i list_sse2_cmpeq_u64(__m128i a, __m128i b) {
+    __m128i halves = _mm_cmpeq_epi32(a, b);
+    return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+static inline __m128i list_sse2_cmpeq_f32(__m128i a, __m128i b) {
+    return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+}
+
+static inline __m128i list_sse2_cmpeq_f64(__m128i a, __m128i b) {
+    return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)));
+}
+
+LIST_SSE2_KERNELS_(u8, list_simd_u8, list_sse2_set1_u8, _mm_cmpeq_epi8)
+LIST_SSE2_KERNELS_(u16, list_simd_u16, list_sse2_set1_u16, _mm_cmpeq_epi16)
+LIST_SSE2_KERNELS_(u32, list_simd_u32, list_sse2_set1_u32, _mm_cmpeq_epi32)
+LIST_SSE2_KERNELS_(u64, list_simd_u64, list_sse2_set1_u64, list_sse2_cmpeq_u64)
+LIST_SSE2_KERNELS_(f32, list_simd_f32, list_sse2_set1_f32, list_sse2_cmpeq_f32)
+LIST_SSE2_KERNELS_(f64, list_simd_f64, list_sse2_set1_f64, list_sse2_cmpeq_f64)
+
+#define LIST_AVX2_ATTR __attribute__((target("avx2")))
+
+#define LIST_AVX2_KERNELS_(suffix, ctype, SET1, CMPEQ)                                               \
+    LIST_SIMD_KERNELS_(avx2, LIST_AVX2_ATTR, __m256i, _mm256_loadu_si256, _mm256_storeu_si256,       \
+                       _mm256_movemask_epi8, _mm256_and_si256, _mm256_andnot_si256, _mm256_or_si256, \
+                       suffix, ctype, SET1, CMPEQ)
+
+static inline LIST_AVX2_ATTR __m256i list_avx2_set1_u8(uint8_t v) { return _mm256_set1_epi8((char)v); }
+static inline LIST_AVX2_ATTR __m256i list_avx2_set1_u16(uint16_t v) { return _mm256_set1_epi16((short)v); }
+static inline LIST_AVX2_ATTR __m256i list_avx2_set1_u32(uint32_t v) { return _mm256_set1_epi32((int)v); }
+static inline LIST_AVX2_ATTR __m256i list_avx2_set1_u64(uint64_t v) { return _mm256_set1_epi64x((long long)v); }
+static inline LIST_AVX2_ATTR __m256i list_avx2_set1_f32(float v) { return _mm256_castps_si256(_mm256_set1_ps(v)); }
+static inline LIST_AVX2_ATTR __m256i list_avx2_set1_f64(double v) { return _mm256_castpd_si256(_mm256_set1_pd(v)); }
+
+static inline LIST_AVX2_ATTR __m256i list_avx2_cmpeq_f32(__m256i a, __m256i b) {
+    return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+}
+
+static inline LIST_AVX2_ATTR __m256i list_avx2_cmpeq_f64(__m256i a, __m256i b) {
+    return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+}
+
+LIST_AVX2_KERNELS_(u8, list_simd_u8, list_avx2_set1_u8, _mm256_cmpeq_epi8)
+LIST_AVX2_KERNELS_(u16, list_simd_u16, list_avx2_set1_u16, _mm256_cmpeq_epi16)
+LIST_AVX2_KERNELS_(u32, list_simd_u32, list_avx2_set1_u32, _mm256_cmpeq_epi32)
+LIST_AVX2_KERNELS_(u64, list_simd_u64, list_avx2_set1_u64, _mm256_cmpeq_epi64)
+LIST_AVX2_KERNELS_(f32, list_simd_f32, list_avx2_set1_f32, list_avx2_cmpeq_f32)
+LIST_AVX2_KERNELS_(f64, list_simd_f64, list_avx2_set1_f64, list_avx2_cmpeq_f64)
+
+static inline bool list_simd_has_avx2(void) {
+#if defined(__AVX2__)
+    return true;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#define LIST_SIMD_CALL_(op, suffix, ...) \
+    (list_simd_has_avx2() ? list_##op##_avx2_##suffix(__VA_ARGS__) : list_##op##_sse2_##suffix(__VA_ARGS__))
+
+/* Expands `op` for the lane type matching (kind, width); falls through when there is none. */
+#define LIST_SIMD_SWITCH_(op, kind, width, ARGS)                                    \
+    if ((kind) == LIST_SIMD_FLOAT) {                                                \
+        if ((width) == 4) { return LIST_SIMD_CALL_(op, f32, ARGS(list_simd_f32)); } \
+        if ((width) == 8) { return LIST_SIMD_CALL_(op, f64, ARGS(list_simd_f64)); } \
+    } else if ((kind) == LIST_SIMD_INT) {                                           \
+        if ((width) == 1) { return LIST_SIMD_CALL_(op, u8, ARGS(list_simd_u8)); }   \
+        if ((width) == 2) { return LIST_SIMD_CALL_(op, u16, ARGS(list_simd_u16)); } \
+        if ((width) == 4) { return LIST_SIMD_CALL_(op, u32, ARGS(list_simd_u32)); } \
+        if ((width) == 8) { return LIST_SIMD_CALL_(op, u64, ARGS(list_simd_u64)); } \
+    }
+
+#define LIST_SIMD_SCAN_ARGS_(ctype) (const ctype *)data, n, *(const ctype *)value
+#define LIST_SIMD_REPLACE_ARGS_(ctype) (ctype *)data, n, *(const ctype *)old_value, *(const ctype *)new_value
+#endif
+
+/* Index of the first element equal to *value (n if none), or LIST_SIMD_UNSUPPORTED. */
+static inline size_t list_simd_find(int kind, size_t width, const void *data, size_t n, const void *value) {
+#ifdef LIST_SIMD
+    LIST_SIMD_SWITCH_(find, kind, width, LIST_SIMD_SCAN_ARGS_)
+#else
+    (void)kind; (void)width; (void)data; (void)n; (void)value;
+#endif
+    return LIST_SIMD_UNSUPPORTED;
+}
+
+static inline size_t list_simd_count(int kind, size_t width, const void *data, size_t n, const void *value) {
+#ifdef LIST_SIMD
+    LIST_SIMD_SWITCH_(count, kind, width, LIST_SIMD_SCAN_ARGS_)
+#else
+    (void)kind; (void)width; (void)data; (void)n; (void)value;
+#endif
+    return LIST_SIMD_UNSUPPORTED;
+}
+
+/* Number of elements replaced, or LIST_SIMD_UNSUPPORTED. */
+static inline size_t list_simd_replace(int kind, size_t width, void *data, size_t n,
+                                       const void *old_value, const void *new_value) {
+#ifdef LIST_SIMD
+    LIST_SIMD_SWITCH_(replace, kind, width, LIST_SIMD_REPLACE_ARGS_)
+#else
+    (void)kind; (void)width; (void)data; (void)n; (void)old_value; (void)new_value;
+#endif
+    return LIST_SIMD_UNSUPPORTED;
+}
+
+/*
+ * Removes every element equal to *value, moving the runs between matches
+ * with memmove. Returns the new count, or LIST_SIMD_UNSUPPORTED.
+ */
+static inline size_t list_simd_remove(int kind, size_t width, void *data, size_t n, const void *value) {
+    size_t write = list_simd_find(kind, width, data, n, value);
+    if (write == LIST_SIMD_UNSUPPORTED) {
+        return LIST_SIMD_UNSUPPORTED;
+    }
+    char *bytes = (char *)data;
+    size_t read = write;
+    while (read < n) {
+        read++;
+        size_t next = read + list_simd_find(kind, width, bytes + read * width, n - read, value);
+        memmove(bytes + write * width, bytes + read * width, (next - read) * width);
+        write += next - read;
+        read = next;
+    }
+    return write;
+}
+
+/*
+ * Per-type instrumentation, compiled in only with C_LIST_STATS. Every
+ * ListDef'd type then owns a `List_stats list_name_stats` counter block;
+ * the counters are not atomic, so concurrent lists of one type race on them.
+ */
+typedef struct {
+    unsigned long long reallocations;
+    unsigned long long bytes_copied;
+    unsigned long long element_shifts;
+    unsigned long long find_scans;
+    unsigned long long current_bytes;
+    unsigned long long peak_bytes;
+} List_stats;
+
+static inline void list_stats_resize(List_stats *stats, size_t old_bytes, size_t new_bytes) {
+    stats->current_bytes += (unsigned long long)new_bytes - (unsigned long long)old_bytes;
+    if (stats->current_bytes > stats->peak_bytes) {
+        stats->peak_bytes = stats->current_bytes;
+    }
+}
+
+static inline void list_stats_dump(const char *name, List_stats stats, FILE *out) {
+    fprintf(out, "%s: reallocations=%llu bytes_copied=%llu element_shifts=%llu find_scans=%llu "
+                 "current_bytes=%llu peak_bytes=%llu\n",
+            name, stats.reallocations, stats.bytes_copied, stats.element_shifts, stats.find_scans,
+            stats.current_bytes, stats.peak_bytes);
+}
+
+/*
+ * Define C_LIST_INLINE before including the header to generate the list
+ * functions of ListDec/ListDef and of the companion macros (ordered, index,
+ * file, concurrent, parallel, deque, ...) as static inline instead of
+ * external functions. The macros can then live in a shared header, and get_,
+ * push_, size_ and friends inline into the caller. Each translation unit gets its
+ * own _default_element and instrumentation counters.
+ */
+#if defined(C_LIST_INLINE)
+#define LIST_FN static inline
+#define LIST_VAR static
+#else
+#define LIST_FN
+#define LIST_VAR
+#endif
+
+#ifdef C_LIST_STATS
+#ifdef C_LIST_INLINE
+#define LIST_STATS_DECLARE_(list_name) static List_stats list_name##_stats;
+#define LIST_STATS_DEFINE_(list_name)
+#else
+#define LIST_STATS_DECLARE_(list_name) extern List_stats list_name##_stats;
+#define LIST_STATS_DEFINE_(list_name) List_stats list_name##_stats = {0};
+#endif
+#define LIST_STATS_GET_(list_name) (list_name##_stats)
+#define LIST_STATS_RESET_(list_name) (list_name##_stats = (List_stats){0})
+#define LIST_STAT_(list_name, field, n) (list_name##_stats.field += (unsigned long long)(n))
+#define LIST_STAT_RESIZE_(list_name, old_bytes, new_bytes) \
+    list_stats_resize(&list_name##_stats, old_bytes, new_bytes)
+#else
+#define LIST_STATS_DECLARE_(list_name)
+#define LIST_STATS_DEFINE_(list_name)
+#define LIST_STATS_GET_(list_name) ((List_stats){0})
+#define LIST_STATS_RESET_(list_name) ((void)0)
+#define LIST_STAT_(list_name, field, n) ((void)0)
+#define LIST_STAT_RESIZE_(list_name, old_bytes, new_bytes) ((void)0)
+#endif
+
+/* Records `n` elements moved within a buffer. */
+#define LIST_STAT_SHIFT_(list_name, type, n) \
+    (LIST_STAT_(list_name, element_shifts, n), LIST_STAT_(list_name, bytes_copied, sizeof(type) * (n)))
+
+#define ListDec(type, list_name) ListDecWithSize(type, list_name, int, int, INT_MAX)
+
+/* Same API with size_t sizes and ptrdiff_t indices, for lists beyond INT_MAX elements. */
+#define ListDec64(type, list_name) ListDecWithSize(type, list_name, size_t, ptrdiff_t, PTRDIFF_MAX)
+
+/*
+ * size_type stores capacity and count, index_type is the signed result of
+ * find_ (-1 when absent) and max_count bounds the number of elements.
+ */
+#define ListDecWithSize(type, list_name, size_type, index_type, max_count)                  \
+    LIST_DEC_(type, list_name, size_type, index_type, max_count, 0, , NULL)
+
+/*
+ * Same API, but the first N elements live inside the struct: a list that
+ * never exceeds N elements makes no heap allocation for its buffer, and
+ * none at all when declared as a local and set up with init_. Do not copy
+ * such a list by value; data may point into the struct itself.
+ */
+#define ListDecSBO(type, list_name, N) \
+    LIST_DEC_(type, list_name, int, int, INT_MAX, N, type inline_data[N];, list->inline_data)
+
+#define LIST_DEC_(type, list_name, size_type, index_type, max_count, inline_count, inline_field, inline_data_expr) \
+    typedef size_type list_name##_size_t;                                                              \
+    typedef index_type list_name##_index_t;                                                            \
+    typedef struct                                                                                     \
+    {                                                                                                  \
+        list_name##_size_t capacity;                                                                   \
+        list_name##_size_t count;                                                                      \
+        type *data;                                                                                    \
+        List_errno err;                                                                                \
+        inline_field                                                                                   \
+    } list_name;                                                                                       \
+    static inline type *list_name##_inline_data(list_name *list) {                                     \
+        (void)list;                                                                                    \
+        return inline_data_expr;                                                                       \
+    }                                                                                                  \
+    static inline size_t list_name##_inline_capacity(void) {                                           \
+        return (size_t)(inline_count);                                                                 \
+    }                                                                                                  \
+    typedef struct                                                                                     \
+    {                                                                                                  \
+        type const *data;                                                                              \
+        size_t count;                                                                                  \
+    } list_name##_view;                                                                                \
+    LIST_VAR type list_name##_default_element;                                                         \
+    LIST_STATS_DECLARE_(list_name)                                                                     \
+    static inline size_t list_name##_max_capacity(void) {                                              \
+        return list_capacity_limit((size_t)(max_count), sizeof(type));                                 \
+    }                                                                                                  \
+                                                                                                       \
+    /* Unchecked access for hot loops: no NULL, bounds or capacity checks, no errno. */                \
+    static inline type *data_##list_name(list_name *list) {                                            \
+        return list->data;                                                                             \
+    }                                                                                                  \
+    static inline type *at_##list_name(list_name *list, size_t index) {                                \
+        return list->data + index;                                                                     \
+    }                                                                                                  \
+    static inline void push_unchecked_##list_name(list_name *list, type Element) {                     \
+        list->data[list->count++] = Element;                                                           \
+    }                                                                                                  \
+                                                                                                       \
+    LIST_FN List_errno get_errno_##list_name(list_name *list);                                         \
+    LIST_FN void set_errno_##list_name(list_name *list, List_errno e);                                 \
+    LIST_FN list_name *create_##list_name();                                                           \
+    LIST_FN void destroy_##list_name(list_name *list);                                                 \
+    LIST_FN void init_##list_name(list_name *list);                                                    \
+    LIST_FN bool push_##list_name(list_name *list, type Element);                                      \
+    LIST_FN type pop_##list_name(list_name *list);                                                     \
+    LIST_FN bool resize_##list_name(list_name *list, list_name##_size_t new_capacity);                 \
+    LIST_FN bool expand_##list_name(list_name *list);                                                  \
+    LIST_FN bool shrink_##list_name(list_name *list);                                                  \
+    LIST_FN bool shrink_to_fit_##list_name(list_name *list);                                           \
+    LIST_FN void clear_keep_capacity_##list_name(list_name *list);                                     \
+    LIST_FN type first_##list_name(list_name *list);                                                   \
+    LIST_FN type back_##list_name(list_name *list);                                                    \
+    LIST_FN type get_##list_name(list_name *list, size_t index);                                       \
+    LIST_FN bool set_##list_name(list_name *list, size_t index, type Element);                         \
+    LIST_FN list_name##_index_t find_##list_name(list_name *list, type Element);                       \
+    LIST_FN list_name##_size_t count_##list_name(list_name *list, type Element);                       \
+    LIST_FN void free_##list_name(list_name *list);                                                    \
+    LIST_FN list_name##_size_t size_##list_name(list_name *list);                                      \
+    LIST_FN list_name##_size_t capacity_##list_name(list_name *list);                                  \
+    LIST_FN bool empty_##list_name(list_name *list);                                                   \
+    LIST_FN void clear_##list_name(list_name *list);                                                   \
+    LIST_FN list_name *extend_##list_name(list_name *list_a, list_name *list_b);                       \
+    LIST_FN bool insert_##list_name(list_name *list, size_t index, type Element);                      \
+    LIST_FN bool remove_at_##list_name(list_name *list, size_t index);                                 \
+    LIST_FN bool reserve_##list_name(list_name *list, size_t capacity);                                \
+    LIST_FN bool push_n_##list_name(list_name *list, type Element, size_t n);                          \
+    LIST_FN bool append_array_##list_name(list_name *list, type const *arr, size_t len);               \
+    LIST_FN bool insert_range_##list_name(list_name *list, size_t index, type const *arr, size_t len); \
+    LIST_FN bool erase_range_##list_name(list_name *list, size_t start, size_t end);                   \
+    LIST_FN void remove_##list_name(list_name *list, type Element);                                    \
+    LIST_FN size_t remove_if_##list_name(list_name *list, bool (*pred)(type));                         \
+    LIST_FN size_t retain_if_##list_name(list_name *list, bool (*pred)(type));                         \
+    LIST_FN size_t dedup_adjacent_##list_name(list_name *list);                                        \
+    LIST_FN list_name##_index_t partition_##list_name(list_name *list, bool (*pred)(type));            \
+    LIST_FN list_name *sublist_##list_name(list_name *list, size_t start, size_t end);                 \
+    LIST_FN void replace_##list_name(list_name *list, type oldElement, type newElement);               \
+    LIST_FN void print_##list_name(list_name *list, void (*printElement)(type));                       \
+    LIST_FN list_name *from_array_##list_name(type *arr, size_t len);                                  \
+    LIST_FN type *to_array_##list_name(list_name *list);                                               \
+    LIST_FN type *release_##list_name(list_name *list, size_t *len);                                   \
+    LIST_FN list_name *adopt_##list_name(type *data, size_t len, size_t capacity);                     \
+    LIST_FN list_name##_view view_##list_name(list_name *list, size_t start, size_t end);              \
+    LIST_FN list_name##_view view_array_##list_name(type const *arr, size_t len);                      \
+    LIST_FN list_name##_view subview_##list_name(list_name##_view view, size_t start, size_t end);     \
+    LIST_FN type view_get_##list_name(list_name##_view view, size_t index);                            \
+    LIST_FN list_name##_index_t view_find_##list_name(list_name##_view view, type Element);            \
+    LIST_FN void view_for_each_##list_name(list_name##_view view, void (*fn)(type));                   \
+    LIST_FN list_name *view_to_list_##list_name(list_name##_view view);                                \
+    LIST_FN List_stats get_stats_##list_name(void);                                                    \
+    LIST_FN void reset_stats_##list_name(void);                                                        \
+    LIST_FN void dump_stats_##list_name(FILE *out);
+
+
+/*
+ * Iterates `it` (a type *) over the elements of a list, or any struct with
+ * data and count fields, with no per-element calls or checks. `list` is
+ * evaluated more than once; the list must not be resized in the body.
+ */
+#define LIST_FOREACH(type, it, list)                                                                       \
+    for (type *it = (list)->data, *it##_end = (list)->count ? (list)->data + (list)->count : (list)->data; \
+         it != it##_end; ++it)
+
+#define LIST_EQ(a, b) ((a) == (b))
+
+/* 1 when EQ is the LIST_EQ token itself; the vectorized scans assume == semantics. */
+#define LIST_SECOND_(a, b, ...) b
+#define LIST_SECOND(...) LIST_SECOND_(__VA_ARGS__)
+#define LIST_PROBE_LIST_EQ ~, 1
+#define LIST_IS_DEFAULT_EQ(EQ) LIST_SECOND(LIST_PROBE_##EQ, 0, ~)
+#define LIST_SIMD_KIND_EQ(EQ, x) (LIST_IS_DEFAULT_EQ(EQ) ? LIST_SIMD_KIND(x) : LIST_SIMD_NONE)
+
+#define ListDef(type, list_name) ListDefWith(type, list_name, NULL, NULL, LIST_EQ)
+
+#define ListDefWithAllocator(type, list_name, alloc_ctx) ListDefWith(type, list_name, alloc_ctx, NULL, LIST_EQ)
+
+#define ListDefWithPolicy(type, list_name, policy_ctx) ListDefWith(type, list_name, NULL, policy_ctx, LIST_EQ)
+
+/* For element types without ==, e.g. structs. */
+#define ListDefWithEq(type, list_name, EQ) ListDefWith(type, list_name, NULL, NULL, EQ)
+
+/*
+ * alloc_ctx is a `const List_allocator *` expression, evaluated on every allocation.
+ * policy_ctx is a `const List_policy *` expression, evaluated on every grow/shrink.
+ * Either may be NULL for the defaults. EQ(a, b) compares two elements in
+ * find_, count_, remove_, replace_ and view_find_.
+ */
+#define ListDefWith(type, list_name, alloc_ctx, policy_ctx, EQ)                                \
+    LIST_STATS_DEFINE_(list_name)                                                              \
+                                                                                               \
+    LIST_FN List_errno get_errno_##list_name(list_name *list){                                 \
         if (list == NULL) {                                                                    \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return LIST_NOT_EXIST;                                                             \
         }                                                                                      \
-        List_errno errno = list->err;                                                          \
+        List_errno err = list->err;                                                            \
         list->err = LIST_OK;                                                                   \
         set_list_errno(LIST_OK);                                                               \
-        return errno;                                                                          \
+        return err;                                                                            \
 }                                                                                              \
                                                                                                \
-    void set_errno_##list_name(list_name *list, List_errno e){                                 \
+    LIST_FN void set_errno_##list_name(list_name *list, List_errno e){                         \
         if (list == NULL) {                                                                    \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return;                                                                            \
         }                                                                                      \
-        list->err = e;                                                                         \
-        set_list_errno(e);                                                                     \
+        list_store_errno(&list->err, e);                                                       \
     }                                                                                          \
                                                                                                \
-    void init_##list_name(list_name *list) {                                                   \
+    LIST_FN void init_##list_name(list_name *list) {                                           \
         if(list == NULL){                                                                      \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return;                                                                            \
         }                                                                                      \
-        list->data = NULL;                                                                     \
-        list->capacity = 0;                                                                    \
+        list->data = list_name##_inline_data(list);                                            \
+        list->capacity = (list_name##_size_t)list_name##_inline_capacity();                    \
         list->count = 0;                                                                       \
         list->err = LIST_OK;                                                                   \
         set_list_errno(LIST_OK);                                                               \
     }                                                                                          \
                                                                                                \
-    list_name *create_##list_name(){                                                           \
-        list_name *newlist = (list_name*)malloc(sizeof(list_name));                            \
+    LIST_FN list_name *create_##list_name(){                                                   \
+        list_name *newlist = (list_name*)list_reallocate((alloc_ctx), NULL, 0, sizeof(list_name)); \
         if(newlist == NULL){                                                                   \
             set_list_errno(LIST_ALLOCATION_FAILED);                                            \
             return NULL;                                                                       \
@@ -176,17 +845,17 @@ static inline const char *clean_list_errno() {
         return newlist;                                                                        \
 }                                                                                              \
                                                                                                \
-    void destroy_##list_name(list_name *list){                                                 \
+    LIST_FN void destroy_##list_name(list_name *list){                                         \
         if(list == NULL){                                                                      \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return;                                                                            \
         }                                                                                      \
         free_##list_name(list);                                                                \
-        free(list);                                                                            \
+        list_reallocate((alloc_ctx), list, sizeof(list_name), 0);                              \
         set_list_errno(LIST_OK);                                                               \
     }                                                                                          \
                                                                                                \
-    bool push_##list_name(list_name *list, type Element){                                      \
+    LIST_FN bool push_##list_name(list_name *list, type Element){                              \
         if(list == NULL){                                                                      \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return false;                                                                      \
@@ -202,7 +871,7 @@ static inline const char *clean_list_errno() {
         return true;                                                                           \
     }                                                                                          \
                                                                                                \
-    type pop_##list_name(list_name *list){                                                     \
+    LIST_FN type pop_##list_name(list_name *list){                                             \
         if(list == NULL){                                                                      \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return list_name##_default_element;                                                \
@@ -212,44 +881,89 @@ static inline const char *clean_list_errno() {
             return list_name##_default_element;                                                \
         }                                                                                      \
         list->count--;                                                                         \
-        if(list->count * 4 < list->capacity){                                                  \
-            if(!shrink_##list_name(list)){                                                     \
-                return false;                                                                  \
-            }                                                                                  \
+        type element = list->data[list->count];                                                \
+        if(list_policy_should_shrink((policy_ctx), (size_t)list->count, (size_t)list->capacity)){ \
+            shrink_##list_name(list);                                                          \
         }                                                                                      \
         set_errno_##list_name(list, LIST_OK);                                                  \
-        return list->data[list->count];                                                        \
+        return element;                                                                        \
+    }                                                                                          \
+                                                                                               \
+    /* Reallocates the buffer; lists with inline storage move between it and the heap. */      \
+    static type *list_name##_realloc_data(list_name *list, size_t new_capacity) {              \
+        type *inline_data = list_name##_inline_data(list);                                     \
+        if (inline_data == NULL) {                                                             \
+            return CHANGE_ARRAY_WITH((alloc_ctx), type, list->data, list->capacity, new_capacity); \
+        }                                                                                      \
+        if (new_capacity <= list_name##_inline_capacity()) {                                   \
+            if (list->data != inline_data) {                                                   \
+                size_t keep = (size_t)list->count < new_capacity ? (size_t)list->count : new_capacity; \
+                memcpy(inline_data, list->data, keep * sizeof(type));                          \
+                FREE_ARRAY_WITH((alloc_ctx), type, list->data, list->capacity);                \
+            }                                                                                  \
+            return inline_data;                                                                \
+        }                                                                                      \
+        if (list->data == inline_data) {                                                       \
+            type *heap = CHANGE_ARRAY_WITH((alloc_ctx), type, NULL, 0, new_capacity);          \
+            if (heap != NULL) {                                                                \
+                memcpy(heap, inline_data, (size_t)list->count * sizeof(type));                 \
+            }                                                                                  \
+            return heap;                                                                       \
+        }                                                                                      \
+        return CHANGE_ARRAY_WITH((alloc_ctx), type, list->data, list->capacity, new_capacity); \
     }                                                                                          \
                                                                                                \
-    bool resize_##list_name(list_name *list, int new_capacity){                                \
+    LIST_FN bool resize_##list_name(list_name *list, list_name##_size_t new_capacity){         \
         if(list == NULL){                                                                      \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return false;                                                                      \
         }                                                                                      \
-        if (new_capacity < 0){                                                                 \
+        if ((size_t)new_capacity > list_name##_max_capacity()){                                \
             set_errno_##list_name(list, LIST_INVALID_CAPACITY);                                \
             return false;                                                                      \
         }                                                                                      \
-        list->data = CHANGE_ARRAY(type, list->data, list->capacity, new_capacity);             \
-        if(list->data == NULL){                                                                \
+        type *new_data = list_name##_realloc_data(list, (size_t)new_capacity);                 \
+        if(new_data == NULL && new_capacity > 0){                                              \
             set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                               \
             return false;                                                                      \
         }                                                                                      \
-        list->capacity = new_capacity;                                                         \
+        LIST_STAT_(list_name, reallocations, 1);                                               \
+        LIST_STAT_RESIZE_(list_name, sizeof(type) * list->capacity, sizeof(type) * new_capacity); \
         list->count = list->count < new_capacity ? list->count : new_capacity;                 \
+        list->data = new_data;                                                                 \
+        list->capacity = new_data == list_name##_inline_data(list)                             \
+                             ? (list_name##_size_t)list_name##_inline_capacity() : new_capacity; \
         set_errno_##list_name(list, LIST_OK);                                                  \
         return true;                                                                           \
 }                                                                                              \
                                                                                                \
-    bool expand_##list_name(list_name *list){                                                  \
-        return resize_##list_name(list, GROW_CAPACITY(list->capacity));                        \
+    LIST_FN bool expand_##list_name(list_name *list){                                          \
+        size_t new_capacity = list_policy_grow((policy_ctx), (size_t)list->capacity, list_name##_max_capacity()); \
+        if (new_capacity == 0){                                                                \
+            set_errno_##list_name(list, LIST_INVALID_CAPACITY);                                \
+            return false;                                                                      \
+        }                                                                                      \
+        return resize_##list_name(list, (list_name##_size_t)new_capacity);                     \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool shrink_##list_name(list_name *list){                                          \
+        size_t new_capacity = list_policy_shrink((policy_ctx), (size_t)list->count, (size_t)list->capacity); \
+        if (new_capacity >= (size_t)list->capacity || list->data == list_name##_inline_data(list)){ \
+            set_errno_##list_name(list, LIST_OK);                                              \
+            return true;                                                                       \
+        }                                                                                      \
+        return resize_##list_name(list, (list_name##_size_t)new_capacity);                     \
     }                                                                                          \
                                                                                                \
-    bool shrink_##list_name(list_name *list){                                                  \
-        return resize_##list_name(list, DECREASE_CAPACITY(list->capacity));                    \
+    LIST_FN bool shrink_to_fit_##list_name(list_name *list){                                   \
+        if(list == NULL){                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        return resize_##list_name(list, list->count);                                          \
     }                                                                                          \
                                                                                                \
-    type first_##list_name(list_name *list){                                                   \
+    LIST_FN type first_##list_name(list_name *list){                                           \
         if(list == NULL){                                                                      \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return list_name##_default_element;                                                \
@@ -262,7 +976,7 @@ static inline const char *clean_list_errno() {
         return list->data[0];                                                                  \
     }                                                                                          \
                                                                                                \
-    type back_##list_name(list_name *list){                                                    \
+    LIST_FN type back_##list_name(list_name *list){                                            \
         if(list == NULL){                                                                      \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return list_name##_default_element;                                                \
@@ -275,12 +989,12 @@ static inline const char *clean_list_errno() {
         return list->data[list->count-1];                                                      \
     }                                                                                          \
                                                                                                \
-    type get_##list_name(list_name *list, size_t index){                                       \
+    LIST_FN type get_##list_name(list_name *list, size_t index){                               \
         if(list == NULL){                                                                      \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return list_name##_default_element;                                                \
         }                                                                                      \
-        if(index >= list->count){                                                              \
+        if(index >= (size_t)list->count){                                                      \
             set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
             return list_name##_default_element;                                                \
         }                                                                                      \
@@ -288,54 +1002,91 @@ static inline const char *clean_list_errno() {
         return list->data[index];                                                              \
     }                                                                                          \
                                                                                                \
-    bool set_##list_name(list_name *list, size_t index, type Element) {                        \
+    LIST_FN bool set_##list_name(list_name *list, size_t index, type Element) {                \
         if(list == NULL){                                                                      \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return false;                                                                      \
         }                                                                                      \
-        if (index >= list->capacity){                                                          \
+        if (index >= (size_t)list->capacity){                                                  \
             set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
             return false;                                                                      \
         }                                                                                      \
         list->data[index] = Element;                                                           \
-        list->count = index > list->count ? index : list->count;                               \
+        list->count = index > (size_t)list->count ? (list_name##_size_t)index : list->count;   \
         set_errno_##list_name(list, LIST_OK);                                                  \
         return true;                                                                           \
     }                                                                                          \
                                                                                                \
-    int find_##list_name(list_name *list, type Element){                                       \
+    LIST_FN list_name##_index_t find_##list_name(list_name *list, type Element){               \
         if(list == NULL){                                                                      \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return -1;                                                                         \
         }                                                                                      \
         set_errno_##list_name(list, LIST_OK);                                                  \
-        for (int i = 0; i < list->count; i++){                                                 \
-            if (list->data[i]==Element) {                                                      \
-                return i;                                                                      \
+        LIST_STAT_(list_name, find_scans, 1);                                                  \
+        size_t index = list_simd_find(LIST_SIMD_KIND_EQ(EQ, Element), sizeof(type), list->data, (size_t)list->count, &Element); \
+        if (index != LIST_SIMD_UNSUPPORTED) {                                                  \
+            return index < (size_t)list->count ? (list_name##_index_t)index : -1;              \
+        }                                                                                      \
+        for (list_name##_size_t i = 0; i < list->count; i++){                                  \
+            if (EQ(list->data[i], Element)) {                                                  \
+                return (list_name##_index_t)i;                                                 \
             }                                                                                  \
         }                                                                                      \
         return -1;                                                                             \
     }                                                                                          \
                                                                                                \
-    void free_##list_name(list_name *list){                                                    \
+    LIST_FN list_name##_size_t count_##list_name(list_name *list, type Element){               \
+        if(list == NULL){                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return 0;                                                                          \
+        }                                                                                      \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        LIST_STAT_(list_name, find_scans, 1);                                                  \
+        size_t count = list_simd_count(LIST_SIMD_KIND_EQ(EQ, Element), sizeof(type), list->data, (size_t)list->count, &Element); \
+        if (count != LIST_SIMD_UNSUPPORTED) {                                                  \
+            return (list_name##_size_t)count;                                                  \
+        }                                                                                      \
+        list_name##_size_t matches = 0;                                                        \
+        for (list_name##_size_t i = 0; i < list->count; i++){                                  \
+            if (EQ(list->data[i], Element)) {                                                  \
+                matches++;                                                                     \
+            }                                                                                  \
+        }                                                                                      \
+        return matches;                                                                        \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN void free_##list_name(list_name *list){                                            \
         if(list == NULL){                                                                      \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return;                                                                            \
         }                                                                                      \
-        FREE_ARRAY(type, list->data, list->capacity);                                          \
+        if (list->data != list_name##_inline_data(list)) {                                     \
+            FREE_ARRAY_WITH((alloc_ctx), type, list->data, list->capacity);                    \
+        }                                                                                      \
+        LIST_STAT_RESIZE_(list_name, sizeof(type) * list->capacity, 0);                        \
         init_##list_name(list);                                                                \
         set_errno_##list_name(list, LIST_OK);                                                  \
     }                                                                                          \
                                                                                                \
-    int size_##list_name(list_name *list) { return list->count; }                              \
+    LIST_FN list_name##_size_t size_##list_name(list_name *list) { return list->count; }       \
                                                                                                \
-    int capacity_##list_name(list_name *list) { return list->capacity; }                       \
+    LIST_FN list_name##_size_t capacity_##list_name(list_name *list) { return list->capacity; } \
                                                                                                \
-    bool empty_##list_name(list_name *list) { return list->count == 0; }                       \
+    LIST_FN bool empty_##list_name(list_name *list) { return list->count == 0; }               \
                                                                                                \
-    void clear_##list_name(list_name *list) { free_##list_name(list); }                        \
+    LIST_FN void clear_##list_name(list_name *list) { free_##list_name(list); }                \
                                                                                                \
-    list_name *extend_##list_name(list_name *list_a, list_name *list_b) {                      \
+    LIST_FN void clear_keep_capacity_##list_name(list_name *list) {                            \
+        if(list == NULL){                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return;                                                                            \
+        }                                                                                      \
+        list->count = 0;                                                                       \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name *extend_##list_name(list_name *list_a, list_name *list_b) {              \
         if (list_a == NULL) {                                                                  \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return NULL;                                                                       \
@@ -344,24 +1095,26 @@ static inline const char *clean_list_errno() {
             set_errno_##list_name(list_a, LIST_NOT_EXIST);                                     \
             return NULL;                                                                       \
         }                                                                                      \
-        if(list_a->capacity < list_a->count + list_b->count){                                  \
-            int new_capacity = next_power_of_2(list_a->count+list_b->count);                   \
-            if(!resize_##list_name(list_a, new_capacity)){                                     \
-                return NULL;                                                                   \
-            }                                                                                  \
+        if((size_t)list_b->count > list_name##_max_capacity() - (size_t)list_a->count){        \
+            set_errno_##list_name(list_a, LIST_INVALID_CAPACITY);                              \
+            return NULL;                                                                       \
+        }                                                                                      \
+        if(!reserve_##list_name(list_a, (size_t)(list_a->count + list_b->count))){             \
+            return NULL;                                                                       \
         }                                                                                      \
         memcpy(list_a->data + list_a->count, list_b->data, sizeof(type) * list_b->count);      \
+        LIST_STAT_(list_name, bytes_copied, sizeof(type) * list_b->count);                     \
         list_a->count += list_b->count;                                                        \
         set_errno_##list_name(list_a, LIST_OK);                                                \
         return list_a;                                                                         \
     }                                                                                          \
                                                                                                \
-    bool insert_##list_name(list_name *list, size_t index, type Element) {                     \
+    LIST_FN bool insert_##list_name(list_name *list, size_t index, type Element) {             \
         if (list == NULL) {                                                                    \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return false;                                                                      \
         }                                                                                      \
-        if (index > list->count) {                                                             \
+        if (index > (size_t)list->count) {                                                     \
             set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
             return false;                                                                      \
         }                                                                                      \
@@ -370,29 +1123,27 @@ static inline const char *clean_list_errno() {
                 return false;                                                                  \
             }                                                                                  \
         }                                                                                      \
-        for (int i = list->count; i > index; i--) {                                            \
-            list->data[i] = list->data[i - 1];                                                 \
-        }                                                                                      \
+        memmove(list->data + index + 1, list->data + index, sizeof(type) * (list->count - index)); \
+        LIST_STAT_SHIFT_(list_name, type, list->count - index);                                \
         list->data[index] = Element;                                                           \
         list->count++;                                                                         \
         set_errno_##list_name(list, LIST_OK);                                                  \
         return true;                                                                           \
     }                                                                                          \
                                                                                                \
-    bool remove_at_##list_name(list_name *list, size_t index) {                                \
+    LIST_FN bool remove_at_##list_name(list_name *list, size_t index) {                        \
         if (list == NULL) {                                                                    \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return false;                                                                      \
         }                                                                                      \
-        if (index >= list->count) {                                                            \
+        if (index >= (size_t)list->count) {                                                    \
             set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
             return false;                                                                      \
         }                                                                                      \
-        for (int i = index; i < list->count - 1; i++) {                                        \
-            list->data[i] = list->data[i + 1];                                                 \
-        }                                                                                      \
+        memmove(list->data + index, list->data + index + 1, sizeof(type) * (list->count - index - 1)); \
+        LIST_STAT_SHIFT_(list_name, type, list->count - index - 1);                            \
         list->count--;                                                                         \
-        if(list->count * 4 < list->capacity){                                                  \
+        if(list_policy_should_shrink((policy_ctx), (size_t)list->count, (size_t)list->capacity)){ \
             if(!shrink_##list_name(list)){                                                     \
                 return false;                                                                  \
             }                                                                                  \
@@ -401,109 +1152,332 @@ static inline const char *clean_list_errno() {
         return true;                                                                           \
     }                                                                                          \
                                                                                                \
-    void remove_##list_name(list_name *list, type Element){                                    \
+    LIST_FN bool reserve_##list_name(list_name *list, size_t capacity) {                       \
         if (list == NULL) {                                                                    \
             set_list_errno(LIST_NOT_EXIST);                                                    \
-            return;                                                                            \
+            return false;                                                                      \
         }                                                                                      \
-        int offset = 0;                                                                        \
-        for (int i = 0; i < list->count; i++) {                                                \
-            if (list->data[i] == Element) {                                                    \
-                offset++;                                                                      \
-            } else {                                                                           \
-            list->data[i - offset] = list->data[i];                                            \
-            }                                                                                  \
+        if (capacity > list_name##_max_capacity()) {                                           \
+            set_errno_##list_name(list, LIST_INVALID_CAPACITY);                                \
+            return false;                                                                      \
         }                                                                                      \
-        list->count -= offset;                                                                 \
-        if (list->count * 4 < list->capacity) {                                                \
-            shrink_##list_name(list);                                                          \
+        if ((size_t)list->capacity < capacity) {                                               \
+            size_t new_capacity = list_next_power_of_2(capacity, list_name##_max_capacity());  \
+            return resize_##list_name(list, (list_name##_size_t)new_capacity);                 \
         }                                                                                      \
         set_errno_##list_name(list, LIST_OK);                                                  \
+        return true;                                                                           \
     }                                                                                          \
                                                                                                \
-    void print_##list_name(list_name *list, void (*printElement)(type)){                       \
-        if(list == NULL) {                                                                     \
-            printf("NULL\n");                                                                  \
+    LIST_FN bool push_n_##list_name(list_name *list, type Element, size_t n) {                 \
+        if (list == NULL) {                                                                    \
             set_list_errno(LIST_NOT_EXIST);                                                    \
-            return;                                                                            \
+            return false;                                                                      \
         }                                                                                      \
-        if(printElement == NULL){                                                              \
-            set_errno_##list_name(list, LIST_INVALID_PRINTFN);                                 \
-            return;                                                                            \
+        if (n > list_name##_max_capacity() - (size_t)list->count) {                            \
+            set_errno_##list_name(list, LIST_INVALID_CAPACITY);                                \
+            return false;                                                                      \
         }                                                                                      \
-        printf("[");                                                                           \
-        for (int i = 0; i < list->count; i++) {                                                \
-            printElement(list->data[i]);                                                       \
-            if(i < list->count - 1) {                                                          \
-                printf(",");                                                                   \
-            }                                                                                  \
+        if (!reserve_##list_name(list, (size_t)list->count + n)) {                             \
+            return false;                                                                      \
         }                                                                                      \
-        printf("]\n");                                                                         \
+        type *dst = list->data + list->count;                                                  \
+        for (size_t i = 0; i < n; i++) {                                                       \
+            dst[i] = Element;                                                                  \
+        }                                                                                      \
+        list->count += (list_name##_size_t)n;                                                  \
         set_errno_##list_name(list, LIST_OK);                                                  \
+        return true;                                                                           \
     }                                                                                          \
                                                                                                \
-    list_name *sublist_##list_name(list_name *list, size_t start, size_t end) {                \
+    LIST_FN bool append_array_##list_name(list_name *list, type const *arr, size_t len) {      \
+        return insert_range_##list_name(list, list == NULL ? 0 : (size_t)list->count, arr, len); \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool insert_range_##list_name(list_name *list, size_t index, type const *arr, size_t len) { \
         if (list == NULL) {                                                                    \
             set_list_errno(LIST_NOT_EXIST);                                                    \
-            return NULL;                                                                       \
+            return false;                                                                      \
+        }                                                                                      \
+        if (arr == NULL && len > 0) {                                                          \
+            set_errno_##list_name(list, LIST_INVALID_RAW_ARRAY);                               \
+            return false;                                                                      \
+        }                                                                                      \
+        if (index > (size_t)list->count) {                                                     \
+            set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (len > list_name##_max_capacity() - (size_t)list->count) {                          \
+            set_errno_##list_name(list, LIST_INVALID_CAPACITY);                                \
+            return false;                                                                      \
+        }                                                                                      \
+        if (len == 0) {                                                                        \
+            set_errno_##list_name(list, LIST_OK);                                              \
+            return true;                                                                       \
+        }                                                                                      \
+        /* arr may point into the list itself: remember where, since reserve_ can move the buffer. */ \
+        bool aliased = list->data != NULL && (uintptr_t)arr >= (uintptr_t)list->data &&        \
+                       (uintptr_t)arr < (uintptr_t)(list->data + list->capacity);              \
+        size_t offset = aliased ? (size_t)(arr - list->data) : 0;                              \
+        if (!reserve_##list_name(list, (size_t)list->count + len)) {                           \
+            return false;                                                                      \
+        }                                                                                      \
+        memmove(list->data + index + len, list->data + index, sizeof(type) * (list->count - index)); \
+        if (aliased) {                                                                         \
+            /* Source elements before index stayed put; those at or after it moved up by len. */ \
+            size_t before = offset < index ? (index - offset < len ? index - offset : len) : 0; \
+            memcpy(list->data + index, list->data + offset, sizeof(type) * before);            \
+            memcpy(list->data + index + before, list->data + offset + before + len, sizeof(type) * (len - before)); \
+        } else {                                                                               \
+            memcpy(list->data + index, arr, sizeof(type) * len);                               \
+        }                                                                                      \
+        LIST_STAT_SHIFT_(list_name, type, list->count - index);                                \
+        LIST_STAT_(list_name, bytes_copied, sizeof(type) * len);                               \
+        list->count += (list_name##_size_t)len;                                                \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool erase_range_##list_name(list_name *list, size_t start, size_t end) {          \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
         }                                                                                      \
         if (start > end || end > (size_t)list->count) {                                        \
             set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
-            return NULL;                                                                       \
+            return false;                                                                      \
         }                                                                                      \
-        size_t new_count = end - start;                                                        \
-        list_name *newlist = create_##list_name();                                             \
-        if (newlist == NULL) {                                                                 \
-            set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                               \
-            return NULL;                                                                       \
+        if (start == end) {                                                                    \
+            set_errno_##list_name(list, LIST_OK);                                              \
+            return true;                                                                       \
         }                                                                                      \
-        if (!resize_##list_name(newlist, next_power_of_2(new_count))) {                        \
-            destroy_##list_name(newlist);                                                      \
-            set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                               \
-            return NULL;                                                                       \
+        memmove(list->data + start, list->data + end, sizeof(type) * (list->count - end));     \
+        LIST_STAT_SHIFT_(list_name, type, list->count - end);                                  \
+        list->count -= (list_name##_size_t)(end - start);                                      \
+        size_t new_capacity = list_policy_shrink_target((policy_ctx), (size_t)list->count, (size_t)list->capacity); \
+        if (new_capacity < (size_t)list->capacity) {                                           \
+            resize_##list_name(list, (list_name##_size_t)new_capacity);                        \
         }                                                                                      \
-        memcpy(newlist->data, list->data + start, sizeof(type) * new_count);                   \
-        newlist->count = new_count;                                                            \
         set_errno_##list_name(list, LIST_OK);                                                  \
-        return newlist;                                                                        \
-       }                                                                                       \
+        return true;                                                                           \
+    }                                                                                          \
                                                                                                \
-    void replace_##list_name(list_name *list, type oldElement, type newElement) {              \
+    LIST_FN void remove_##list_name(list_name *list, type Element){                            \
         if (list == NULL) {                                                                    \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return;                                                                            \
         }                                                                                      \
-        for (int i = 0; i < list->count; i++) {                                                \
-            if (list->data[i] == oldElement) {                                                 \
-                list->data[i] = newElement;                                                    \
+        size_t new_count = list_simd_remove(LIST_SIMD_KIND_EQ(EQ, Element), sizeof(type), list->data, (size_t)list->count, &Element); \
+        if (new_count != LIST_SIMD_UNSUPPORTED) {                                              \
+            list->count = (list_name##_size_t)new_count;                                       \
+        } else {                                                                               \
+            list_name##_size_t offset = 0;                                                     \
+            for (list_name##_size_t i = 0; i < list->count; i++) {                             \
+                if (EQ(list->data[i], Element)) {                                              \
+                    offset++;                                                                  \
+                } else {                                                                       \
+                    list->data[i - offset] = list->data[i];                                    \
+                }                                                                              \
             }                                                                                  \
+            list->count -= offset;                                                             \
+        }                                                                                      \
+        if (list_policy_should_shrink((policy_ctx), (size_t)list->count, (size_t)list->capacity)) { \
+            shrink_##list_name(list);                                                          \
         }                                                                                      \
         set_errno_##list_name(list, LIST_OK);                                                  \
     }                                                                                          \
                                                                                                \
-    list_name *from_array_##list_name(type *arr, size_t len) {                                 \
-        if (arr == NULL && len > 0) {                                                          \
-            set_list_errno(LIST_INVALID_RAW_ARRAY);                                            \
-            return NULL;                                                                       \
-        }                                                                                      \
-        list_name *newlist = create_##list_name();                                             \
-        if (newlist == NULL) {                                                                 \
-            set_list_errno(LIST_ALLOCATION_FAILED);                                            \
-            return NULL;                                                                       \
+    /* Drops everything past new_count, then makes one shrink decision for the whole batch. */ \
+    static size_t list_name##_truncate(list_name *list, size_t new_count) {                    \
+        size_t removed = (size_t)list->count - new_count;                                      \
+        list->count = (list_name##_size_t)new_count;                                           \
+        size_t new_capacity = list_policy_shrink_target((policy_ctx), new_count, (size_t)list->capacity); \
+        if (new_capacity < (size_t)list->capacity) {                                           \
+            resize_##list_name(list, (list_name##_size_t)new_capacity);                        \
         }                                                                                      \
-        int capacity = next_power_of_2(len);                                                   \
-        if (!resize_##list_name(newlist, capacity)) {                                          \
-            destroy_##list_name(newlist);                                                      \
-            set_list_errno(LIST_ALLOCATION_FAILED);                                            \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return removed;                                                                        \
+    }                                                                                          \
+                                                                                               \
+    /* Keeps the elements for which pred(element) == keep, in order; returns how many were dropped. */ \
+    static size_t list_name##_filter(list_name *list, bool (*pred)(type), bool keep) {         \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return 0;                                                                          \
+        }                                                                                      \
+        if (pred == NULL) {                                                                    \
+            set_errno_##list_name(list, LIST_INVALID_PRINTFN);                                 \
+            return 0;                                                                          \
+        }                                                                                      \
+        size_t kept = 0;                                                                       \
+        for (size_t i = 0; i < (size_t)list->count; i++) {                                     \
+            if (pred(list->data[i]) == keep) {                                                 \
+                list->data[kept++] = list->data[i];                                            \
+            }                                                                                  \
+        }                                                                                      \
+        return list_name##_truncate(list, kept);                                               \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN size_t remove_if_##list_name(list_name *list, bool (*pred)(type)) {                \
+        return list_name##_filter(list, pred, false);                                          \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN size_t retain_if_##list_name(list_name *list, bool (*pred)(type)) {                \
+        return list_name##_filter(list, pred, true);                                           \
+    }                                                                                          \
+                                                                                               \
+    /* Collapses each run of EQ elements to its first element. */                              \
+    LIST_FN size_t dedup_adjacent_##list_name(list_name *list) {                               \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return 0;                                                                          \
+        }                                                                                      \
+        if (list->count == 0) {                                                                \
+            set_errno_##list_name(list, LIST_OK);                                              \
+            return 0;                                                                          \
+        }                                                                                      \
+        size_t kept = 1;                                                                       \
+        for (size_t i = 1; i < (size_t)list->count; i++) {                                     \
+            if (!(EQ(list->data[kept - 1], list->data[i]))) {                                  \
+                list->data[kept++] = list->data[i];                                            \
+            }                                                                                  \
+        }                                                                                      \
+        return list_name##_truncate(list, kept);                                               \
+    }                                                                                          \
+                                                                                               \
+    /*                                                                                         \
+     * Stable partition: elements matching pred first, then the rest, each group               \
+     * in its original order. Returns the index of the first non-matching element,             \
+     * or -1 if the scratch buffer for the non-matching elements cannot be allocated.          \
+     */                                                                                        \
+    LIST_FN list_name##_index_t partition_##list_name(list_name *list, bool (*pred)(type)) {   \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return -1;                                                                         \
+        }                                                                                      \
+        if (pred == NULL) {                                                                    \
+            set_errno_##list_name(list, LIST_INVALID_PRINTFN);                                 \
+            return -1;                                                                         \
+        }                                                                                      \
+        size_t count = (size_t)list->count;                                                    \
+        type *rest = count ? CHANGE_ARRAY_WITH((alloc_ctx), type, NULL, 0, count) : NULL;      \
+        if (rest == NULL && count > 0) {                                                       \
+            set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                               \
+            return -1;                                                                         \
+        }                                                                                      \
+        size_t matched = 0, rest_count = 0;                                                    \
+        for (size_t i = 0; i < count; i++) {                                                   \
+            if (pred(list->data[i])) {                                                         \
+                list->data[matched++] = list->data[i];                                         \
+            } else {                                                                           \
+                rest[rest_count++] = list->data[i];                                            \
+            }                                                                                  \
+        }                                                                                      \
+        if (rest_count > 0) {                                                                  \
+            memcpy(list->data + matched, rest, sizeof(type) * rest_count);                     \
+            LIST_STAT_(list_name, bytes_copied, sizeof(type) * rest_count);                    \
+        }                                                                                      \
+        if (rest != NULL) {                                                                    \
+            FREE_ARRAY_WITH((alloc_ctx), type, rest, count);                                   \
+        }                                                                                      \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return (list_name##_index_t)matched;                                                   \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN void print_##list_name(list_name *list, void (*printElement)(type)){               \
+        if(list == NULL) {                                                                     \
+            printf("NULL\n");                                                                  \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return;                                                                            \
+        }                                                                                      \
+        if(printElement == NULL){                                                              \
+            set_errno_##list_name(list, LIST_INVALID_PRINTFN);                                 \
+            return;                                                                            \
+        }                                                                                      \
+        printf("[");                                                                           \
+        for (list_name##_size_t i = 0; i < list->count; i++) {                                 \
+            printElement(list->data[i]);                                                       \
+            if(i < list->count - 1) {                                                          \
+                printf(",");                                                                   \
+            }                                                                                  \
+        }                                                                                      \
+        printf("]\n");                                                                         \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name *sublist_##list_name(list_name *list, size_t start, size_t end) {        \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
             return NULL;                                                                       \
         }                                                                                      \
-        memcpy(newlist->data, arr, sizeof(type) * len);                                        \
-        newlist->count = (int)len;                                                             \
+        if (start > end || end > (size_t)list->count) {                                        \
+            set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
+            return NULL;                                                                       \
+        }                                                                                      \
+        size_t new_count = end - start;                                                        \
+        list_name *newlist = create_##list_name();                                             \
+        if (newlist == NULL) {                                                                 \
+            set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                               \
+            return NULL;                                                                       \
+        }                                                                                      \
+        if (!resize_##list_name(newlist, (list_name##_size_t)list_next_power_of_2(new_count, list_name##_max_capacity()))) { \
+            destroy_##list_name(newlist);                                                      \
+            set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                               \
+            return NULL;                                                                       \
+        }                                                                                      \
+        memcpy(newlist->data, list->data + start, sizeof(type) * new_count);                   \
+        LIST_STAT_(list_name, bytes_copied, sizeof(type) * new_count);                         \
+        newlist->count = (list_name##_size_t)new_count;                                        \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return newlist;                                                                        \
+       }                                                                                       \
+                                                                                               \
+    LIST_FN void replace_##list_name(list_name *list, type oldElement, type newElement) {      \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return;                                                                            \
+        }                                                                                      \
+        if (list_simd_replace(LIST_SIMD_KIND_EQ(EQ, oldElement), sizeof(type), list->data, (size_t)list->count, \
+                              &oldElement, &newElement) == LIST_SIMD_UNSUPPORTED) {            \
+            for (list_name##_size_t i = 0; i < list->count; i++) {                             \
+                if (EQ(list->data[i], oldElement)) {                                           \
+                    list->data[i] = newElement;                                                \
+                }                                                                              \
+            }                                                                                  \
+        }                                                                                      \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name *from_array_##list_name(type *arr, size_t len) {                         \
+        if (arr == NULL && len > 0) {                                                          \
+            set_list_errno(LIST_INVALID_RAW_ARRAY);                                            \
+            return NULL;                                                                       \
+        }                                                                                      \
+        if (len > list_name##_max_capacity()) {                                                \
+            set_list_errno(LIST_INVALID_CAPACITY);                                             \
+            return NULL;                                                                       \
+        }                                                                                      \
+        list_name *newlist = create_##list_name();                                             \
+        if (newlist == NULL) {                                                                 \
+            set_list_errno(LIST_ALLOCATION_FAILED);                                            \
+            return NULL;                                                                       \
+        }                                                                                      \
+        size_t capacity = list_next_power_of_2(len, list_name##_max_capacity());               \
+        if (!resize_##list_name(newlist, (list_name##_size_t)capacity)) {                      \
+            destroy_##list_name(newlist);                                                      \
+            set_list_errno(LIST_ALLOCATION_FAILED);                                            \
+            return NULL;                                                                       \
+        }                                                                                      \
+        if (len > 0) {                                                                         \
+            memcpy(newlist->data, arr, sizeof(type) * len);                                    \
+            LIST_STAT_(list_name, bytes_copied, sizeof(type) * len);                           \
+        }                                                                                      \
+        newlist->count = (list_name##_size_t)len;                                              \
         set_errno_##list_name(newlist, LIST_OK);                                               \
         return newlist;                                                                        \
     }                                                                                          \
                                                                                                \
-    type *to_array_##list_name(list_name *list) {                                              \
+    LIST_FN type *to_array_##list_name(list_name *list) {                                      \
         if (list == NULL) {                                                                    \
             set_list_errno(LIST_NOT_EXIST);                                                    \
             return NULL;                                                                       \
@@ -518,7 +1492,3858 @@ static inline const char *clean_list_errno() {
             return NULL;                                                                       \
         }                                                                                      \
         memcpy(arr, list->data, sizeof(type) * list->count);                                   \
+        LIST_STAT_(list_name, bytes_copied, sizeof(type) * list->count);                       \
         set_errno_##list_name(list, LIST_OK);                                                  \
         return arr;                                                                            \
+    }                                                                                          \
+                                                                                               \
+    /*                                                                                         \
+     * Hands the buffer to the caller and leaves the list empty. Inline storage                \
+     * cannot be handed off, so a list still using it is copied out instead.                   \
+     */                                                                                        \
+    LIST_FN type *release_##list_name(list_name *list, size_t *len) {                          \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return NULL;                                                                       \
+        }                                                                                      \
+        type *data = list->data;                                                               \
+        size_t count = (size_t)list->count;                                                    \
+        if (list_name##_inline_capacity() > 0 && data == list_name##_inline_data(list)) {      \
+            data = count ? CHANGE_ARRAY_WITH((alloc_ctx), type, NULL, 0, count) : NULL;        \
+            if (data == NULL && count > 0) {                                                   \
+                set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                           \
+                return NULL;                                                                   \
+            }                                                                                  \
+            if (count > 0) {                                                                   \
+                memcpy(data, list_name##_inline_data(list), sizeof(type) * count);             \
+                LIST_STAT_(list_name, bytes_copied, sizeof(type) * count);                     \
+            }                                                                                  \
+        } else if (data != NULL) {                                                             \
+            LIST_STAT_RESIZE_(list_name, sizeof(type) * list->capacity, 0);                    \
+        }                                                                                      \
+        if (len != NULL) {                                                                     \
+            *len = count;                                                                      \
+        }                                                                                      \
+        init_##list_name(list);                                                                \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return data;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* Takes ownership of data, which must come from the list's allocator; on failure the caller keeps it. */ \
+    LIST_FN list_name *adopt_##list_name(type *data, size_t len, size_t capacity) {            \
+        if (data == NULL && capacity > 0) {                                                    \
+            set_list_errno(LIST_INVALID_RAW_ARRAY);                                            \
+            return NULL;                                                                       \
+        }                                                                                      \
+        if (len > capacity || capacity > list_name##_max_capacity()) {                         \
+            set_list_errno(LIST_INVALID_CAPACITY);                                             \
+            return NULL;                                                                       \
+        }                                                                                      \
+        list_name *newlist = create_##list_name();                                             \
+        if (newlist == NULL) {                                                                 \
+            return NULL;                                                                       \
+        }                                                                                      \
+        if (data != NULL) {                                                                    \
+            newlist->data = data;                                                              \
+            newlist->capacity = (list_name##_size_t)capacity;                                  \
+            newlist->count = (list_name##_size_t)len;                                          \
+            LIST_STAT_RESIZE_(list_name, 0, sizeof(type) * capacity);                          \
+        }                                                                                      \
+        set_errno_##list_name(newlist, LIST_OK);                                               \
+        return newlist;                                                                        \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name##_view view_##list_name(list_name *list, size_t start, size_t end) {     \
+        list_name##_view view = {NULL, 0};                                                     \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return view;                                                                       \
+        }                                                                                      \
+        if (start > end || end > (size_t)list->count) {                                        \
+            set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
+            return view;                                                                       \
+        }                                                                                      \
+        view.data = list->data + start;                                                        \
+        view.count = end - start;                                                              \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return view;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name##_view view_array_##list_name(type const *arr, size_t len) {             \
+        list_name##_view view = {NULL, 0};                                                     \
+        if (arr == NULL && len > 0) {                                                          \
+            set_list_errno(LIST_INVALID_RAW_ARRAY);                                            \
+            return view;                                                                       \
+        }                                                                                      \
+        view.data = arr;                                                                       \
+        view.count = len;                                                                      \
+        set_list_errno(LIST_OK);                                                               \
+        return view;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name##_view subview_##list_name(list_name##_view view, size_t start, size_t end) { \
+        list_name##_view sub = {NULL, 0};                                                      \
+        if (start > end || end > view.count) {                                                 \
+            set_list_errno(LIST_OUT_OF_RANGE);                                                 \
+            return sub;                                                                        \
+        }                                                                                      \
+        sub.data = view.data + start;                                                          \
+        sub.count = end - start;                                                               \
+        set_list_errno(LIST_OK);                                                               \
+        return sub;                                                                            \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN type view_get_##list_name(list_name##_view view, size_t index) {                   \
+        if (index >= view.count) {                                                             \
+            set_list_errno(LIST_OUT_OF_RANGE);                                                 \
+            return list_name##_default_element;                                                \
+        }                                                                                      \
+        set_list_errno(LIST_OK);                                                               \
+        return view.data[index];                                                               \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name##_index_t view_find_##list_name(list_name##_view view, type Element) {   \
+        set_list_errno(LIST_OK);                                                               \
+        size_t index = list_simd_find(LIST_SIMD_KIND_EQ(EQ, Element), sizeof(type), view.data, view.count, &Element); \
+        if (index != LIST_SIMD_UNSUPPORTED) {                                                  \
+            return index < view.count ? (list_name##_index_t)index : -1;                       \
+        }                                                                                      \
+        for (size_t i = 0; i < view.count; i++) {                                              \
+            if (EQ(view.data[i], Element)) {                                                   \
+                return (list_name##_index_t)i;                                                 \
+            }                                                                                  \
+        }                                                                                      \
+        return -1;                                                                             \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN void view_for_each_##list_name(list_name##_view view, void (*fn)(type)) {          \
+        if (fn == NULL) {                                                                      \
+            set_list_errno(LIST_INVALID_PRINTFN);                                              \
+            return;                                                                            \
+        }                                                                                      \
+        for (size_t i = 0; i < view.count; i++) {                                              \
+            fn(view.data[i]);                                                                  \
+        }                                                                                      \
+        set_list_errno(LIST_OK);                                                               \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name *view_to_list_##list_name(list_name##_view view) {                       \
+        return from_array_##list_name((type *)view.data, view.count);                          \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN List_stats get_stats_##list_name(void) { return LIST_STATS_GET_(list_name); }      \
+                                                                                               \
+    LIST_FN void reset_stats_##list_name(void) { LIST_STATS_RESET_(list_name); }               \
+                                                                                               \
+    LIST_FN void dump_stats_##list_name(FILE *out) {                                           \
+        list_stats_dump(#list_name, LIST_STATS_GET_(list_name), out == NULL ? stderr : out);   \
+    }
+
+
+#define LIST_LESS(a, b) ((a) < (b))
+
+#define ListDecOrdered(type, list_name)                                                 \
+    LIST_FN void sort_##list_name(list_name *list);                                     \
+    LIST_FN list_name##_size_t lower_bound_##list_name(list_name *list, type Element);  \
+    LIST_FN list_name##_size_t upper_bound_##list_name(list_name *list, type Element);  \
+    LIST_FN list_name##_index_t binary_find_##list_name(list_name *list, type Element); \
+    LIST_FN bool insert_sorted_##list_name(list_name *list, type Element);              \
+    LIST_FN size_t unique_##list_name(list_name *list);                                 \
+    LIST_FN list_name *merge_sorted_##list_name(list_name *list_a, list_name *list_b);
+
+/*
+ * Sorted-list operations for a ListDef'd list. LESS(a, b) is a macro or
+ * function returning true when a orders before b; it is expanded inline,
+ * so the compare loops contain no indirect calls.
+ */
+#define ListDefOrdered(type, list_name, LESS)                 \
+    LIST_DEF_INTROSORT_(type, list_name, LESS)                \
+    static void list_name##_sort_data(type *data, size_t n) { \
+        list_name##_introsort(data, n, 2 * list_log2(n));     \
+    }                                                         \
+    LIST_DEF_ORDERED_(type, list_name, LESS)
+
+/* Ordered operations for integer element types; large lists are radix sorted. */
+#define ListDefOrderedInt(type, list_name)                                       \
+    LIST_DEF_INTROSORT_(type, list_name, LIST_LESS)                              \
+    LIST_DEF_RADIX_SORT_(type, list_name)                                        \
+    static void list_name##_sort_data(type *data, size_t n) {                    \
+        if (n < LIST_RADIX_SORT_THRESHOLD || !list_name##_radix_sort(data, n)) { \
+            list_name##_introsort(data, n, 2 * list_log2(n));                    \
+        }                                                                        \
+    }                                                                            \
+    LIST_DEF_ORDERED_(type, list_name, LIST_LESS)
+
+#define LIST_RADIX_SORT_THRESHOLD 256
+
+static inline size_t list_log2(size_t n) {
+    size_t log = 0;
+    while (n > 1) {
+        n >>= 1;
+        log++;
+    }
+    return log;
+}
+
+#define LIST_DEF_INTROSORT_(type, list_name, LESS)                                                     \
+    static void list_name##_insertion_sort(type *data, size_t n) {                                     \
+        for (size_t i = 1; i < n; i++) {                                                               \
+            type x = data[i];                                                                          \
+            size_t j = i;                                                                              \
+            while (j > 0 && LESS(x, data[j - 1])) {                                                    \
+                data[j] = data[j - 1];                                                                 \
+                j--;                                                                                   \
+            }                                                                                          \
+            data[j] = x;                                                                               \
+        }                                                                                              \
+    }                                                                                                  \
+                                                                                                       \
+    static void list_name##_sift_down(type *data, size_t root, size_t n) {                             \
+        type x = data[root];                                                                           \
+        size_t child;                                                                                  \
+        while ((child = 2 * root + 1) < n) {                                                           \
+            if (child + 1 < n && LESS(data[child], data[child + 1])) {                                 \
+                child++;                                                                               \
+            }                                                                                          \
+            if (!LESS(x, data[child])) {                                                               \
+                break;                                                                                 \
+            }                                                                                          \
+            data[root] = data[child];                                                                  \
+            root = child;                                                                              \
+        }                                                                                              \
+        data[root] = x;                                                                                \
+    }                                                                                                  \
+                                                                                                       \
+    static void list_name##_heap_sort(type *data, size_t n) {                                          \
+        for (size_t i = n / 2; i > 0; i--) {                                                           \
+            list_name##_sift_down(data, i - 1, n);                                                     \
+        }                                                                                              \
+        for (size_t end = n; end > 1; end--) {                                                         \
+            type top = data[0];                                                                        \
+            data[0] = data[end - 1];                                                                   \
+            data[end - 1] = top;                                                                       \
+            list_name##_sift_down(data, 0, end - 1);                                                   \
+        }                                                                                              \
+    }                                                                                                  \
+                                                                                                       \
+    static void list_name##_introsort(type *data, size_t n, size_t depth) {                            \
+        while (n > 16) {                                                                               \
+            if (depth == 0) {                                                                          \
+                list_name##_heap_sort(data, n);                                                        \
+                return;                                                                                \
+            }                                                                                          \
+            depth--;                                                                                   \
+            size_t mid = n / 2;                                                                        \
+            type tmp;                                                                                  \
+            if (LESS(data[mid], data[0])) { tmp = data[mid]; data[mid] = data[0]; data[0] = tmp; }     \
+            if (LESS(data[n - 1], data[mid])) {                                                        \
+                tmp = data[mid]; data[mid] = data[n - 1]; data[n - 1] = tmp;                           \
+                if (LESS(data[mid], data[0])) { tmp = data[mid]; data[mid] = data[0]; data[0] = tmp; } \
+            }                                                                                          \
+            type pivot = data[mid];                                                                    \
+            size_t i = 0, j = n - 1;                                                                   \
+            for (;;) {                                                                                 \
+                while (LESS(data[i], pivot)) { i++; }                                                  \
+                while (LESS(pivot, data[j])) { j--; }                                                  \
+                if (i >= j) {                                                                          \
+                    break;                                                                             \
+                }                                                                                      \
+                tmp = data[i]; data[i] = data[j]; data[j] = tmp;                                       \
+                i++;                                                                                   \
+                j--;                                                                                   \
+            }                                                                                          \
+            size_t left = j + 1;                                                                       \
+            if (left < n - left) {                                                                     \
+                list_name##_introsort(data, left, depth);                                              \
+                data += left;                                                                          \
+                n -= left;                                                                             \
+            } else {                                                                                   \
+                list_name##_introsort(data + left, n - left, depth);                                   \
+                n = left;                                                                              \
+            }                                                                                          \
+        }                                                                                              \
+        list_name##_insertion_sort(data, n);                                                           \
+    }
+
+/*
+ * LSD radix sort on the raw integer value, one byte per pass. Passes in which
+ * every key shares the same byte are skipped. Returns false if the scratch
+ * buffer cannot be allocated.
+ */
+#define LIST_DEF_RADIX_SORT_(type, list_name)                                                  \
+    static bool list_name##_radix_sort(type *data, size_t n) {                                 \
+        type *scratch = (type *)malloc(sizeof(type) * n);                                      \
+        if (scratch == NULL) {                                                                 \
+            return false;                                                                      \
+        }                                                                                      \
+        const int bits = (int)(sizeof(type) * CHAR_BIT);                                       \
+        const uint64_t flip = ((type)-1 < (type)0) ? (uint64_t)1 << (bits - 1) : 0;            \
+        size_t histogram[sizeof(type)][256];                                                   \
+        memset(histogram, 0, sizeof(histogram));                                               \
+        for (size_t i = 0; i < n; i++) {                                                       \
+            uint64_t key = (uint64_t)data[i] ^ flip;                                           \
+            for (size_t b = 0; b < sizeof(type); b++) {                                        \
+                histogram[b][(key >> (8 * b)) & 0xFF]++;                                       \
+            }                                                                                  \
+        }                                                                                      \
+        type *src = data, *dst = scratch;                                                      \
+        for (size_t b = 0; b < sizeof(type); b++) {                                            \
+            size_t *counts = histogram[b];                                                     \
+            if (counts[((uint64_t)src[0] ^ flip) >> (8 * b) & 0xFF] == n) {                    \
+                continue;                                                                      \
+            }                                                                                  \
+            size_t offset = 0;                                                                 \
+            for (int d = 0; d < 256; d++) {                                                    \
+                size_t c = counts[d];                                                          \
+                counts[d] = offset;                                                            \
+                offset += c;                                                                   \
+            }                                                                                  \
+            for (size_t i = 0; i < n; i++) {                                                   \
+                dst[counts[(((uint64_t)src[i] ^ flip) >> (8 * b)) & 0xFF]++] = src[i];         \
+            }                                                                                  \
+            type *tmp = src;                                                                   \
+            src = dst;                                                                         \
+            dst = tmp;                                                                         \
+        }                                                                                      \
+        if (src != data) {                                                                     \
+            memcpy(data, src, sizeof(type) * n);                                               \
+        }                                                                                      \
+        free(scratch);                                                                         \
+        return true;                                                                           \
+    }
+
+#define LIST_DEF_ORDERED_(type, list_name, LESS)                                                  \
+    LIST_FN void sort_##list_name(list_name *list) {                                              \
+        if (list == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                       \
+            return;                                                                               \
+        }                                                                                         \
+        list_name##_sort_data(list->data, (size_t)list->count);                                   \
+        set_errno_##list_name(list, LIST_OK);                                                     \
+    }                                                                                             \
+                                                                                                  \
+    /* Sorts, then keeps one element of each equal run; returns how many were dropped. */         \
+    LIST_FN size_t unique_##list_name(list_name *list) {                                          \
+        if (list == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                       \
+            return 0;                                                                             \
+        }                                                                                         \
+        size_t count = (size_t)list->count;                                                       \
+        if (count == 0) {                                                                         \
+            set_errno_##list_name(list, LIST_OK);                                                 \
+            return 0;                                                                             \
+        }                                                                                         \
+        list_name##_sort_data(list->data, count);                                                 \
+        size_t kept = 1;                                                                          \
+        for (size_t i = 1; i < count; i++) {                                                      \
+            if (LESS(list->data[kept - 1], list->data[i])) {                                      \
+                list->data[kept++] = list->data[i];                                               \
+            }                                                                                     \
+        }                                                                                         \
+        erase_range_##list_name(list, kept, count);                                               \
+        return count - kept;                                                                      \
+    }                                                                                             \
+                                                                                                  \
+    LIST_FN list_name##_size_t lower_bound_##list_name(list_name *list, type Element) {           \
+        if (list == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                       \
+            return 0;                                                                             \
+        }                                                                                         \
+        size_t low = 0, high = (size_t)list->count;                                               \
+        while (low < high) {                                                                      \
+            size_t mid = low + (high - low) / 2;                                                  \
+            if (LESS(list->data[mid], Element)) {                                                 \
+                low = mid + 1;                                                                    \
+            } else {                                                                              \
+                high = mid;                                                                       \
+            }                                                                                     \
+        }                                                                                         \
+        set_errno_##list_name(list, LIST_OK);                                                     \
+        return (list_name##_size_t)low;                                                           \
+    }                                                                                             \
+                                                                                                  \
+    LIST_FN list_name##_size_t upper_bound_##list_name(list_name *list, type Element) {           \
+        if (list == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                       \
+            return 0;                                                                             \
+        }                                                                                         \
+        size_t low = 0, high = (size_t)list->count;                                               \
+        while (low < high) {                                                                      \
+            size_t mid = low + (high - low) / 2;                                                  \
+            if (LESS(Element, list->data[mid])) {                                                 \
+                high = mid;                                                                       \
+            } else {                                                                              \
+                low = mid + 1;                                                                    \
+            }                                                                                     \
+        }                                                                                         \
+        set_errno_##list_name(list, LIST_OK);                                                     \
+        return (list_name##_size_t)low;                                                           \
+    }                                                                                             \
+                                                                                                  \
+    LIST_FN list_name##_index_t binary_find_##list_name(list_name *list, type Element) {          \
+        if (list == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                       \
+            return -1;                                                                            \
+        }                                                                                         \
+        list_name##_size_t index = lower_bound_##list_name(list, Element);                        \
+        if (index < list->count && !LESS(Element, list->data[index])) {                           \
+            return (list_name##_index_t)index;                                                    \
+        }                                                                                         \
+        return -1;                                                                                \
+    }                                                                                             \
+                                                                                                  \
+    LIST_FN bool insert_sorted_##list_name(list_name *list, type Element) {                       \
+        if (list == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                       \
+            return false;                                                                         \
+        }                                                                                         \
+        return insert_##list_name(list, (size_t)upper_bound_##list_name(list, Element), Element); \
+    }                                                                                             \
+                                                                                                  \
+    LIST_FN list_name *merge_sorted_##list_name(list_name *list_a, list_name *list_b) {           \
+        if (list_a == NULL) {                                                                     \
+            set_list_errno(LIST_NOT_EXIST);                                                       \
+            return NULL;                                                                          \
+        }                                                                                         \
+        if (list_b == NULL) {                                                                     \
+            set_errno_##list_name(list_a, LIST_NOT_EXIST);                                        \
+            return NULL;                                                                          \
+        }                                                                                         \
+        size_t count_a = (size_t)list_a->count, count_b = (size_t)list_b->count;                  \
+        if (count_b > list_name##_max_capacity() - count_a) {                                     \
+            set_errno_##list_name(list_a, LIST_INVALID_CAPACITY);                                 \
+            return NULL;                                                                          \
+        }                                                                                         \
+        if (!reserve_##list_name(list_a, count_a + count_b)) {                                    \
+            return NULL;                                                                          \
+        }                                                                                         \
+        type *data = list_a->data;                                                                \
+        if (list_a == list_b) {                                                                   \
+            for (size_t i = count_a; i > 0; i--) {                                                \
+                data[2 * i - 1] = data[i - 1];                                                    \
+                data[2 * i - 2] = data[i - 1];                                                    \
+            }                                                                                     \
+        } else {                                                                                  \
+            size_t i = count_a, j = count_b, k = count_a + count_b;                               \
+            while (j > 0) {                                                                       \
+                if (i > 0 && LESS(list_b->data[j - 1], data[i - 1])) {                            \
+                    data[--k] = data[--i];                                                        \
+                } else {                                                                          \
+                    data[--k] = list_b->data[--j];                                                \
+                }                                                                                 \
+            }                                                                                     \
+        }                                                                                         \
+        list_a->count = (list_name##_size_t)(count_a + count_b);                                  \
+        set_errno_##list_name(list_a, LIST_OK);                                                   \
+        return list_a;                                                                            \
+    }
+
+
+/*
+ * Binary heap operations on a ListDef'd list, in place on list->data. The
+ * heap top is the element that orders first under LESS, so LIST_LESS gives
+ * a min-heap; pass a greater-than macro for a max-heap. LESS is expanded
+ * inline, as in ListDefOrdered.
+ */
+#define ListDecHeap(type, list_name)                                      \
+    LIST_FN void heapify_##list_name(list_name *list);                    \
+    LIST_FN bool heap_push_##list_name(list_name *list, type Element);    \
+    LIST_FN type heap_pop_##list_name(list_name *list);                   \
+    LIST_FN type heap_top_##list_name(list_name *list);                   \
+    LIST_FN type heap_replace_##list_name(list_name *list, type Element); \
+    LIST_FN list_name *top_k_##list_name(list_name *list, size_t k);
+
+/* ORDER is LIST_HEAP_ARGS_ for the heap itself, LIST_HEAP_REVERSED_ for the top-k buffer. */
+#define LIST_HEAP_ARGS_(a, b) a, b
+#define LIST_HEAP_REVERSED_(a, b) b, a
+#define LIST_HEAP_LESS_(LESS, ...) LESS(__VA_ARGS__)
+
+#define LIST_DEF_HEAP_SIFT_DOWN_(type, list_name, suffix, LESS, ORDER)                         \
+    static void list_name##_heap_sift_down##suffix(type *data, size_t n, size_t i) {           \
+        type x = data[i];                                                                      \
+        for (;;) {                                                                             \
+            size_t child = 2 * i + 1;                                                          \
+            if (child >= n) {                                                                  \
+                break;                                                                         \
+            }                                                                                  \
+            if (child + 1 < n && LIST_HEAP_LESS_(LESS, ORDER(data[child + 1], data[child]))) { \
+                child++;                                                                       \
+            }                                                                                  \
+            if (!(LIST_HEAP_LESS_(LESS, ORDER(data[child], x)))) {                             \
+                break;                                                                         \
+            }                                                                                  \
+            data[i] = data[child];                                                             \
+            i = child;                                                                         \
+        }                                                                                      \
+        data[i] = x;                                                                           \
     }
+
+#define ListDefHeap(type, list_name, LESS)                                                     \
+    LIST_DEF_HEAP_SIFT_DOWN_(type, list_name, , LESS, LIST_HEAP_ARGS_)                         \
+    LIST_DEF_HEAP_SIFT_DOWN_(type, list_name, _reverse, LESS, LIST_HEAP_REVERSED_)             \
+                                                                                               \
+    static void list_name##_heap_sift_up(type *data, size_t i) {                               \
+        type x = data[i];                                                                      \
+        while (i > 0) {                                                                        \
+            size_t parent = (i - 1) / 2;                                                       \
+            if (!(LESS(x, data[parent]))) {                                                    \
+                break;                                                                         \
+            }                                                                                  \
+            data[i] = data[parent];                                                            \
+            i = parent;                                                                        \
+        }                                                                                      \
+        data[i] = x;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN void heapify_##list_name(list_name *list) {                                        \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return;                                                                            \
+        }                                                                                      \
+        size_t n = (size_t)list->count;                                                        \
+        for (size_t i = n / 2; i > 0; i--) {                                                   \
+            list_name##_heap_sift_down(list->data, n, i - 1);                                  \
+        }                                                                                      \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool heap_push_##list_name(list_name *list, type Element) {                        \
+        if (!push_##list_name(list, Element)) {                                                \
+            return false;                                                                      \
+        }                                                                                      \
+        list_name##_heap_sift_up(list->data, (size_t)list->count - 1);                         \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN type heap_pop_##list_name(list_name *list) {                                       \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return list_name##_default_element;                                                \
+        }                                                                                      \
+        if (list->count == 0) {                                                                \
+            set_errno_##list_name(list, LIST_EMPTY);                                           \
+            return list_name##_default_element;                                                \
+        }                                                                                      \
+        type top = list->data[0];                                                              \
+        list->data[0] = list->data[list->count - 1];                                           \
+        pop_##list_name(list);                                                                 \
+        if (list->count > 1) {                                                                 \
+            list_name##_heap_sift_down(list->data, (size_t)list->count, 0);                    \
+        }                                                                                      \
+        return top;                                                                            \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN type heap_top_##list_name(list_name *list) {                                       \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return list_name##_default_element;                                                \
+        }                                                                                      \
+        if (list->count == 0) {                                                                \
+            set_errno_##list_name(list, LIST_EMPTY);                                           \
+            return list_name##_default_element;                                                \
+        }                                                                                      \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return list->data[0];                                                                  \
+    }                                                                                          \
+                                                                                               \
+    /* Pops the top and pushes Element with a single sift; the heap must not be empty. */      \
+    LIST_FN type heap_replace_##list_name(list_name *list, type Element) {                     \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return list_name##_default_element;                                                \
+        }                                                                                      \
+        if (list->count == 0) {                                                                \
+            set_errno_##list_name(list, LIST_EMPTY);                                           \
+            return list_name##_default_element;                                                \
+        }                                                                                      \
+        type top = list->data[0];                                                              \
+        list->data[0] = Element;                                                               \
+        list_name##_heap_sift_down(list->data, (size_t)list->count, 0);                        \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return top;                                                                            \
+    }                                                                                          \
+                                                                                               \
+    /*                                                                                         \
+     * New list with the k elements of list that order first, in LESS order.                   \
+     * Keeps a k-element heap rooted at the last of them: O(n log k) time and                  \
+     * O(k) extra space; list itself is not modified.                                          \
+     */                                                                                        \
+    LIST_FN list_name *top_k_##list_name(list_name *list, size_t k) {                          \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return NULL;                                                                       \
+        }                                                                                      \
+        size_t n = (size_t)list->count;                                                        \
+        k = k < n ? k : n;                                                                     \
+        list_name *best = from_array_##list_name(list->data, k);                               \
+        if (best == NULL) {                                                                    \
+            set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                               \
+            return NULL;                                                                       \
+        }                                                                                      \
+        if (k > 0) {                                                                           \
+            for (size_t i = k / 2; i > 0; i--) {                                               \
+                list_name##_heap_sift_down_reverse(best->data, k, i - 1);                      \
+            }                                                                                  \
+            for (size_t i = k; i < n; i++) {                                                   \
+                if (LESS(list->data[i], best->data[0])) {                                      \
+                    best->data[0] = list->data[i];                                             \
+                    list_name##_heap_sift_down_reverse(best->data, k, 0);                      \
+                }                                                                              \
+            }                                                                                  \
+            for (size_t end = k - 1; end > 0; end--) {                                         \
+                type last = best->data[0];                                                     \
+                best->data[0] = best->data[end];                                               \
+                best->data[end] = last;                                                        \
+                list_name##_heap_sift_down_reverse(best->data, end, 0);                        \
+            }                                                                                  \
+        }                                                                                      \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return best;                                                                           \
+    }
+
+
+/*
+ * Hash index companion. A list_nameIndex wraps a list and keeps a hash table
+ * from element to (first position, occurrences) in step with every change
+ * made through its own push_/insert_/set_/remove_at_/remove_/replace_/clear_,
+ * so find_ and contains_ are O(1) expected. Changes made to the list directly
+ * must be followed by rebuild_list_nameIndex().
+ */
+#define LIST_HASH_INT(x) ((uint64_t)(x))
+
+static inline uint64_t list_hash_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+#define ListIndexDec(type, list_name)                                                                   \
+    typedef struct {                                                                                    \
+        type key;                                                                                       \
+        size_t first;                                                                                   \
+        size_t count;                                                                                   \
+        unsigned char state;                                                                            \
+    } list_name##Index_slot;                                                                            \
+    typedef struct {                                                                                    \
+        list_name *list;                                                                                \
+        list_name##Index_slot *slots;                                                                   \
+        size_t capacity;                                                                                \
+        size_t used;                                                                                    \
+        size_t tombstones;                                                                              \
+    } list_name##Index;                                                                                 \
+                                                                                                        \
+    LIST_FN list_name##Index *create_##list_name##Index(list_name *list);                               \
+    LIST_FN void destroy_##list_name##Index(list_name##Index *index);                                   \
+    LIST_FN bool rebuild_##list_name##Index(list_name##Index *index);                                   \
+    LIST_FN bool push_##list_name##Index(list_name##Index *index, type Element);                        \
+    LIST_FN type pop_##list_name##Index(list_name##Index *index);                                       \
+    LIST_FN bool insert_##list_name##Index(list_name##Index *index, size_t position, type Element);     \
+    LIST_FN bool set_##list_name##Index(list_name##Index *index, size_t position, type Element);        \
+    LIST_FN bool remove_at_##list_name##Index(list_name##Index *index, size_t position);                \
+    LIST_FN void remove_##list_name##Index(list_name##Index *index, type Element);                      \
+    LIST_FN void replace_##list_name##Index(list_name##Index *index, type oldElement, type newElement); \
+    LIST_FN void clear_##list_name##Index(list_name##Index *index);                                     \
+    LIST_FN list_name##_index_t find_##list_name##Index(list_name##Index *index, type Element);         \
+    LIST_FN bool contains_##list_name##Index(list_name##Index *index, type Element);                    \
+    LIST_FN list_name##_size_t count_##list_name##Index(list_name##Index *index, type Element);
+
+#define LIST_INDEX_EMPTY 0
+#define LIST_INDEX_USED 1
+#define LIST_INDEX_DELETED 2
+
+/* HASH(x) returns an integer hash of an element, EQ(a, b) compares two elements. */
+#define ListIndexDef(type, list_name, HASH, EQ)                                                                      \
+    static list_name##Index_slot *list_name##Index_lookup(list_name##Index *index, type key) {                       \
+        size_t mask = index->capacity - 1;                                                                           \
+        size_t i = (size_t)list_hash_mix((uint64_t)(HASH(key))) & mask;                                              \
+        while (index->slots[i].state != LIST_INDEX_EMPTY) {                                                          \
+            if (index->slots[i].state == LIST_INDEX_USED && EQ(index->slots[i].key, key)) {                          \
+                return &index->slots[i];                                                                             \
+            }                                                                                                        \
+            i = (i + 1) & mask;                                                                                      \
+        }                                                                                                            \
+        return NULL;                                                                                                 \
+    }                                                                                                                \
+                                                                                                                     \
+    static list_name##Index_slot *list_name##Index_claim(list_name##Index *index, type key) {                        \
+        size_t mask = index->capacity - 1;                                                                           \
+        size_t i = (size_t)list_hash_mix((uint64_t)(HASH(key))) & mask;                                              \
+        list_name##Index_slot *free_slot = NULL;                                                                     \
+        while (index->slots[i].state != LIST_INDEX_EMPTY) {                                                          \
+            if (index->slots[i].state == LIST_INDEX_USED && EQ(index->slots[i].key, key)) {                          \
+                return &index->slots[i];                                                                             \
+            }                                                                                                        \
+            if (free_slot == NULL && index->slots[i].state == LIST_INDEX_DELETED) {                                  \
+                free_slot = &index->slots[i];                                                                        \
+            }                                                                                                        \
+            i = (i + 1) & mask;                                                                                      \
+        }                                                                                                            \
+        if (free_slot == NULL) {                                                                                     \
+            free_slot = &index->slots[i];                                                                            \
+        } else {                                                                                                     \
+            index->tombstones--;                                                                                     \
+        }                                                                                                            \
+        free_slot->state = LIST_INDEX_USED;                                                                          \
+        free_slot->key = key;                                                                                        \
+        free_slot->count = 0;                                                                                        \
+        index->used++;                                                                                               \
+        return free_slot;                                                                                            \
+    }                                                                                                                \
+                                                                                                                     \
+    static void list_name##Index_add(list_name##Index *index, type key, size_t position) {                           \
+        list_name##Index_slot *slot = list_name##Index_claim(index, key);                                            \
+        if (slot->count == 0 || position < slot->first) {                                                            \
+            slot->first = position;                                                                                  \
+        }                                                                                                            \
+        slot->count++;                                                                                               \
+    }                                                                                                                \
+                                                                                                                     \
+    /* Drops the occurrence at `position`, which must still be in the list. */                                       \
+    static void list_name##Index_drop(list_name##Index *index, type key, size_t position) {                          \
+        list_name##Index_slot *slot = list_name##Index_lookup(index, key);                                           \
+        if (slot == NULL) {                                                                                          \
+            return;                                                                                                  \
+        }                                                                                                            \
+        if (--slot->count == 0) {                                                                                    \
+            slot->state = LIST_INDEX_DELETED;                                                                        \
+            index->used--;                                                                                           \
+            index->tombstones++;                                                                                     \
+            return;                                                                                                  \
+        }                                                                                                            \
+        if (slot->first == position) {                                                                               \
+            list_name *list = index->list;                                                                           \
+            size_t i = position + 1;                                                                                 \
+            while (i < (size_t)list->count && !EQ(list->data[i], key)) {                                             \
+                i++;                                                                                                 \
+            }                                                                                                        \
+            slot->first = i;                                                                                         \
+        }                                                                                                            \
+    }                                                                                                                \
+                                                                                                                     \
+    static void list_name##Index_shift(list_name##Index *index, size_t from, bool forward) {                         \
+        for (size_t i = 0; i < index->capacity; i++) {                                                               \
+            list_name##Index_slot *slot = &index->slots[i];                                                          \
+            if (slot->state == LIST_INDEX_USED && slot->first >= from) {                                             \
+                slot->first = forward ? slot->first + 1 : slot->first - 1;                                           \
+            }                                                                                                        \
+        }                                                                                                            \
+    }                                                                                                                \
+                                                                                                                     \
+    static bool list_name##Index_rehash(list_name##Index *index, size_t capacity) {                                  \
+        list_name##Index_slot *slots = (list_name##Index_slot *)calloc(capacity, sizeof(list_name##Index_slot));     \
+        if (slots == NULL) {                                                                                         \
+            return false;                                                                                            \
+        }                                                                                                            \
+        list_name##Index_slot *old_slots = index->slots;                                                             \
+        size_t old_capacity = index->capacity;                                                                       \
+        index->slots = slots;                                                                                        \
+        index->capacity = capacity;                                                                                  \
+        index->used = 0;                                                                                             \
+        index->tombstones = 0;                                                                                       \
+        for (size_t i = 0; i < old_capacity; i++) {                                                                  \
+            if (old_slots[i].state == LIST_INDEX_USED) {                                                             \
+                list_name##Index_slot *slot = list_name##Index_claim(index, old_slots[i].key);                       \
+                slot->first = old_slots[i].first;                                                                    \
+                slot->count = old_slots[i].count;                                                                    \
+            }                                                                                                        \
+        }                                                                                                            \
+        free(old_slots);                                                                                             \
+        return true;                                                                                                 \
+    }                                                                                                                \
+                                                                                                                     \
+    /* Makes room for `extra` new keys so the following updates cannot fail. */                                      \
+    static bool list_name##Index_reserve(list_name##Index *index, size_t extra) {                                    \
+        if ((index->used + index->tombstones + extra) * 4 < index->capacity * 3) {                                   \
+            return true;                                                                                             \
+        }                                                                                                            \
+        size_t capacity = index->capacity;                                                                           \
+        while ((index->used + extra) * 2 >= capacity) {                                                              \
+            capacity *= 2;                                                                                           \
+        }                                                                                                            \
+        if (!list_name##Index_rehash(index, capacity)) {                                                             \
+            set_errno_##list_name(index->list, LIST_ALLOCATION_FAILED);                                              \
+            return false;                                                                                            \
+        }                                                                                                            \
+        return true;                                                                                                 \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN list_name##Index *create_##list_name##Index(list_name *list) {                                           \
+        if (list == NULL) {                                                                                          \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return NULL;                                                                                             \
+        }                                                                                                            \
+        list_name##Index *index = (list_name##Index *)malloc(sizeof(list_name##Index));                              \
+        if (index == NULL) {                                                                                         \
+            set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                                                     \
+            return NULL;                                                                                             \
+        }                                                                                                            \
+        index->list = list;                                                                                          \
+        index->slots = NULL;                                                                                         \
+        index->capacity = 0;                                                                                         \
+        if (!rebuild_##list_name##Index(index)) {                                                                    \
+            free(index);                                                                                             \
+            return NULL;                                                                                             \
+        }                                                                                                            \
+        return index;                                                                                                \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN void destroy_##list_name##Index(list_name##Index *index) {                                               \
+        if (index == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return;                                                                                                  \
+        }                                                                                                            \
+        free(index->slots);                                                                                          \
+        free(index);                                                                                                 \
+        set_list_errno(LIST_OK);                                                                                     \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN bool rebuild_##list_name##Index(list_name##Index *index) {                                               \
+        if (index == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return false;                                                                                            \
+        }                                                                                                            \
+        list_name *list = index->list;                                                                               \
+        size_t capacity = 16;                                                                                        \
+        while ((size_t)list->count * 2 >= capacity) {                                                                \
+            capacity *= 2;                                                                                           \
+        }                                                                                                            \
+        if (capacity != index->capacity) {                                                                           \
+            list_name##Index_slot *slots = (list_name##Index_slot *)calloc(capacity, sizeof(list_name##Index_slot)); \
+            if (slots == NULL) {                                                                                     \
+                set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                                                 \
+                return false;                                                                                        \
+            }                                                                                                        \
+            free(index->slots);                                                                                      \
+            index->slots = slots;                                                                                    \
+            index->capacity = capacity;                                                                              \
+        } else {                                                                                                     \
+            memset(index->slots, 0, sizeof(list_name##Index_slot) * capacity);                                       \
+        }                                                                                                            \
+        index->used = 0;                                                                                             \
+        index->tombstones = 0;                                                                                       \
+        for (size_t i = 0; i < (size_t)list->count; i++) {                                                           \
+            list_name##Index_add(index, list->data[i], i);                                                           \
+        }                                                                                                            \
+        set_errno_##list_name(list, LIST_OK);                                                                        \
+        return true;                                                                                                 \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN bool push_##list_name##Index(list_name##Index *index, type Element) {                                    \
+        if (index == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return false;                                                                                            \
+        }                                                                                                            \
+        if (!list_name##Index_reserve(index, 1)) {                                                                   \
+            return false;                                                                                            \
+        }                                                                                                            \
+        size_t position = (size_t)index->list->count;                                                                \
+        if (!push_##list_name(index->list, Element)) {                                                               \
+            return false;                                                                                            \
+        }                                                                                                            \
+        list_name##Index_add(index, Element, position);                                                              \
+        return true;                                                                                                 \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN type pop_##list_name##Index(list_name##Index *index) {                                                   \
+        if (index == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return list_name##_default_element;                                                                      \
+        }                                                                                                            \
+        list_name *list = index->list;                                                                               \
+        if (list->count > 0) {                                                                                       \
+            list_name##Index_drop(index, list->data[list->count - 1], (size_t)list->count - 1);                      \
+        }                                                                                                            \
+        return pop_##list_name(list);                                                                                \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN bool insert_##list_name##Index(list_name##Index *index, size_t position, type Element) {                 \
+        if (index == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return false;                                                                                            \
+        }                                                                                                            \
+        if (!list_name##Index_reserve(index, 1)) {                                                                   \
+            return false;                                                                                            \
+        }                                                                                                            \
+        if (!insert_##list_name(index->list, position, Element)) {                                                   \
+            return false;                                                                                            \
+        }                                                                                                            \
+        list_name##Index_shift(index, position, true);                                                               \
+        list_name##Index_add(index, Element, position);                                                              \
+        return true;                                                                                                 \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN bool set_##list_name##Index(list_name##Index *index, size_t position, type Element) {                    \
+        if (index == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return false;                                                                                            \
+        }                                                                                                            \
+        list_name *list = index->list;                                                                               \
+        if (position >= (size_t)list->count) {                                                                       \
+            set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                                          \
+            return false;                                                                                            \
+        }                                                                                                            \
+        if (!list_name##Index_reserve(index, 1)) {                                                                   \
+            return false;                                                                                            \
+        }                                                                                                            \
+        list_name##Index_drop(index, list->data[position], position);                                                \
+        list->data[position] = Element;                                                                              \
+        list_name##Index_add(index, Element, position);                                                              \
+        set_errno_##list_name(list, LIST_OK);                                                                        \
+        return true;                                                                                                 \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN bool remove_at_##list_name##Index(list_name##Index *index, size_t position) {                            \
+        if (index == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return false;                                                                                            \
+        }                                                                                                            \
+        list_name *list = index->list;                                                                               \
+        if (position >= (size_t)list->count) {                                                                       \
+            set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                                          \
+            return false;                                                                                            \
+        }                                                                                                            \
+        list_name##Index_drop(index, list->data[position], position);                                                \
+        remove_at_##list_name(list, position);                                                                       \
+        list_name##Index_shift(index, position + 1, false);                                                          \
+        return true;                                                                                                 \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN void remove_##list_name##Index(list_name##Index *index, type Element) {                                  \
+        if (index == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return;                                                                                                  \
+        }                                                                                                            \
+        if (list_name##Index_lookup(index, Element) == NULL) {                                                       \
+            set_errno_##list_name(index->list, LIST_OK);                                                             \
+            return;                                                                                                  \
+        }                                                                                                            \
+        remove_##list_name(index->list, Element);                                                                    \
+        rebuild_##list_name##Index(index);                                                                           \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN void replace_##list_name##Index(list_name##Index *index, type oldElement, type newElement) {             \
+        if (index == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return;                                                                                                  \
+        }                                                                                                            \
+        list_name##Index_slot *slot = list_name##Index_lookup(index, oldElement);                                    \
+        if (slot == NULL || EQ(oldElement, newElement)) {                                                            \
+            set_errno_##list_name(index->list, LIST_OK);                                                             \
+            return;                                                                                                  \
+        }                                                                                                            \
+        if (!list_name##Index_reserve(index, 1)) {                                                                   \
+            return;                                                                                                  \
+        }                                                                                                            \
+        slot = list_name##Index_lookup(index, oldElement);                                                           \
+        size_t first = slot->first, count = slot->count;                                                             \
+        slot->state = LIST_INDEX_DELETED;                                                                            \
+        index->used--;                                                                                               \
+        index->tombstones++;                                                                                         \
+        replace_##list_name(index->list, oldElement, newElement);                                                    \
+        list_name##Index_slot *target = list_name##Index_claim(index, newElement);                                   \
+        if (target->count == 0 || first < target->first) {                                                           \
+            target->first = first;                                                                                   \
+        }                                                                                                            \
+        target->count += count;                                                                                      \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN void clear_##list_name##Index(list_name##Index *index) {                                                 \
+        if (index == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return;                                                                                                  \
+        }                                                                                                            \
+        clear_##list_name(index->list);                                                                              \
+        memset(index->slots, 0, sizeof(list_name##Index_slot) * index->capacity);                                    \
+        index->used = 0;                                                                                             \
+        index->tombstones = 0;                                                                                       \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN list_name##_index_t find_##list_name##Index(list_name##Index *index, type Element) {                     \
+        if (index == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return -1;                                                                                               \
+        }                                                                                                            \
+        list_name##Index_slot *slot = list_name##Index_lookup(index, Element);                                       \
+        set_errno_##list_name(index->list, LIST_OK);                                                                 \
+        return slot == NULL ? -1 : (list_name##_index_t)slot->first;                                                 \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN bool contains_##list_name##Index(list_name##Index *index, type Element) {                                \
+        return find_##list_name##Index(index, Element) >= 0;                                                         \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN list_name##_size_t count_##list_name##Index(list_name##Index *index, type Element) {                     \
+        if (index == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return 0;                                                                                                \
+        }                                                                                                            \
+        list_name##Index_slot *slot = list_name##Index_lookup(index, Element);                                       \
+        set_errno_##list_name(index->list, LIST_OK);                                                                 \
+        return slot == NULL ? 0 : (list_name##_size_t)slot->count;                                                   \
+    }
+
+
+/*
+ * File-backed lists. A list file is a fixed header followed by the raw
+ * elements, so map_ can hand out a pointer into the mapping without copying.
+ * The header records the element size and byte order; files written by a
+ * build with a different layout are rejected with LIST_INVALID_FORMAT.
+ */
+#if defined(__unix__) || defined(__APPLE__)
+#define LIST_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define LIST_FILE_MAGIC "CLST"
+#define LIST_FILE_VERSION 1u
+#define LIST_FILE_BYTE_ORDER 0x01020304u
+#define LIST_FILE_HEADER_SIZE 64
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t element_size;
+    uint64_t count;
+    uint64_t header_size;
+    unsigned char reserved[LIST_FILE_HEADER_SIZE - 32];
+} List_file_header;
+
+_Static_assert(sizeof(List_file_header) == LIST_FILE_HEADER_SIZE, "List_file_header layout");
+
+static inline List_file_header list_file_header(size_t element_size, size_t count) {
+    List_file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LIST_FILE_MAGIC, sizeof(header.magic));
+    header.version = LIST_FILE_VERSION;
+    header.byte_order = LIST_FILE_BYTE_ORDER;
+    header.element_size = (uint32_t)element_size;
+    header.count = (uint64_t)count;
+    header.header_size = sizeof(header);
+    return header;
+}
+
+/* Validates a header against the reading list type; `available` is the number of data bytes present. */
+static inline List_errno list_file_check(const List_file_header *header, size_t element_size, size_t max_count,
+                                         uint64_t available) {
+    if (memcmp(header->magic, LIST_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version == 0 || header->version > LIST_FILE_VERSION ||
+        header->byte_order != LIST_FILE_BYTE_ORDER ||
+        header->element_size != element_size ||
+        header->header_size < sizeof(List_file_header) ||
+        header->header_size % LIST_FILE_HEADER_SIZE != 0) {
+        return LIST_INVALID_FORMAT;
+    }
+    if (header->count > max_count) {
+        return LIST_INVALID_CAPACITY;
+    }
+    if (header->count > available / element_size) {
+        return LIST_INVALID_FORMAT;
+    }
+    return LIST_OK;
+}
+
+static inline List_errno list_file_write_all(FILE *file, const void *data, size_t bytes) {
+    return bytes == 0 || fwrite(data, 1, bytes, file) == bytes ? LIST_OK : LIST_IO_ERROR;
+}
+
+#ifndef LIST_FILE_TMP_ATTEMPTS
+#define LIST_FILE_TMP_ATTEMPTS 64
+#endif
+
+#ifdef LIST_HAVE_MMAP
+#define LIST_FILE_PID() ((long)getpid())
+#else
+#define LIST_FILE_PID() 0L
+#endif
+
+/*
+ * Writes to `path` through a temporary file renamed into place, so processes
+ * that still map the previous version keep valid pages. The temporary file
+ * is created exclusively ("x" mode) under a per-process name, so concurrent
+ * saves to one path never share it. If the old file had to be removed before
+ * the rename and the rename then fails, the temporary file is kept: it holds
+ * the only copy of the data.
+ */
+static inline List_errno list_file_save(const char *path, size_t element_size, const void *data, size_t count) {
+    if (path == NULL) {
+        return LIST_IO_ERROR;
+    }
+    size_t tmp_size = strlen(path) + 48;
+    char *tmp_path = malloc(tmp_size);
+    if (tmp_path == NULL) {
+        return LIST_ALLOCATION_FAILED;
+    }
+    FILE *file = NULL;
+    for (unsigned attempt = 0; file == NULL && attempt < LIST_FILE_TMP_ATTEMPTS; attempt++) {
+        snprintf(tmp_path, tmp_size, "%s.%ld.%u.tmp", path, LIST_FILE_PID(), attempt);
+        file = fopen(tmp_path, "wbx");
+#ifdef LIST_HAVE_MMAP
+        if (file == NULL && errno != EEXIST) {
+            break;
+        }
+#endif
+    }
+    if (file == NULL) {
+        free(tmp_path);
+        return LIST_IO_ERROR;
+    }
+    List_file_header header = list_file_header(element_size, count);
+    List_errno e = list_file_write_all(file, &header, sizeof(header));
+    if (e == LIST_OK) {
+        e = list_file_write_all(file, data, count * element_size);
+    }
+    if (fclose(file) != 0 && e == LIST_OK) {
+        e = LIST_IO_ERROR;
+    }
+    bool path_removed = false;
+    if (e == LIST_OK && rename(tmp_path, path) != 0) {
+        e = LIST_IO_ERROR;
+#ifdef _WIN32
+        /* rename() cannot replace an existing file here. */
+        if (remove(path) == 0) {
+            path_removed = true;
+            if (rename(tmp_path, path) == 0) {
+                e = LIST_OK;
+            }
+        }
+#endif
+    }
+    if (e != LIST_OK && !path_removed) {
+        remove(tmp_path);
+    }
+    free(tmp_path);
+    return e;
+}
+
+static inline void list_file_unmap(void *base, size_t length) {
+    if (base == NULL) {
+        return;
+    }
+#ifdef LIST_HAVE_MMAP
+    munmap(base, length);
+#else
+    (void)length;
+    free(base);
+#endif
+}
+
+/*
+ * Maps a list file. Read-only mappings are shared with every other process
+ * mapping the same file; copy_on_write mappings may be written, and the
+ * changes stay private to the mapping. Without mmap the file is read into
+ * memory instead.
+ */
+static inline List_errno list_file_map(const char *path, size_t element_size, size_t max_count, bool copy_on_write,
+                                       void **base, size_t *length, size_t *count) {
+    *base = NULL;
+    *length = 0;
+    *count = 0;
+    if (path == NULL) {
+        return LIST_IO_ERROR;
+    }
+    void *mapping = NULL;
+    size_t size = 0;
+#ifdef LIST_HAVE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return LIST_IO_ERROR;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return LIST_IO_ERROR;
+    }
+    if ((uint64_t)st.st_size < sizeof(List_file_header) || (uint64_t)st.st_size > SIZE_MAX) {
+        close(fd);
+        return LIST_INVALID_FORMAT;
+    }
+    size = (size_t)st.st_size;
+    mapping = mmap(NULL, size, copy_on_write ? PROT_READ | PROT_WRITE : PROT_READ,
+                   copy_on_write ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return LIST_IO_ERROR;
+    }
+#else
+    (void)copy_on_write;
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return LIST_IO_ERROR;
+    }
+    long end = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        end = ftell(file);
+    }
+    if (end < (long)sizeof(List_file_header) || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return end < 0 ? LIST_IO_ERROR : LIST_INVALID_FORMAT;
+    }
+    size = (size_t)end;
+    mapping = malloc(size);
+    if (mapping == NULL) {
+        fclose(file);
+        return LIST_ALLOCATION_FAILED;
+    }
+    if (fread(mapping, 1, size, file) != size) {
+        fclose(file);
+        free(mapping);
+        return LIST_IO_ERROR;
+    }
+    fclose(file);
+#endif
+    List_file_header header;
+    memcpy(&header, mapping, sizeof(header));
+    List_errno e = header.header_size > size
+                       ? LIST_INVALID_FORMAT
+                       : list_file_check(&header, element_size, max_count, size - header.header_size);
+    if (e != LIST_OK) {
+        list_file_unmap(mapping, size);
+        return e;
+    }
+    *base = mapping;
+    *length = size;
+    *count = (size_t)header.count;
+    return LIST_OK;
+}
+
+/*
+ * Byte sources and sinks for the streaming functions. A reader returns the
+ * number of bytes read, short only at end of stream or on error (then
+ * *failed is set); a writer returns false on error.
+ */
+typedef size_t (*List_read_fn)(void *source, void *buffer, size_t bytes, bool *failed);
+typedef bool (*List_write_fn)(void *sink, const void *buffer, size_t bytes);
+
+#ifndef LIST_STREAM_CHUNK_BYTES
+#define LIST_STREAM_CHUNK_BYTES ((size_t)1 << 20)
+#endif
+
+static inline size_t list_stdio_read(void *source, void *buffer, size_t bytes, bool *failed) {
+    size_t n = fread(buffer, 1, bytes, (FILE *)source);
+    if (n < bytes && ferror((FILE *)source)) {
+        *failed = true;
+    }
+    return n;
+}
+
+static inline bool list_stdio_write(void *sink, const void *buffer, size_t bytes) {
+    return bytes == 0 || fwrite(buffer, 1, bytes, (FILE *)sink) == bytes;
+}
+
+#ifdef LIST_HAVE_MMAP
+static inline size_t list_fd_read(void *source, void *buffer, size_t bytes, bool *failed) {
+    int fd = *(int *)source;
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t n = read(fd, (unsigned char *)buffer + done, bytes - done);
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            *failed = true;
+            break;
+        }
+        done += (size_t)n;
+    }
+    return done;
+}
+
+static inline bool list_fd_write(void *sink, const void *buffer, size_t bytes) {
+    int fd = *(int *)sink;
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t n = write(fd, (const unsigned char *)buffer + done, bytes - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        done += (size_t)n;
+    }
+    return true;
+}
+
+#define LIST_DEC_FD_(list_name)                                 \
+    LIST_FN bool write_fd_##list_name(list_name *list, int fd); \
+    LIST_FN list_name *read_fd_##list_name(int fd);             \
+    LIST_FN list_name##_size_t append_from_fd_##list_name(list_name *list, int fd);
+
+#define LIST_DEF_FD_(list_name)                                                                \
+    LIST_FN bool write_fd_##list_name(list_name *list, int fd) {                               \
+        return list_name##_write_with(list, list_fd_write, &fd);                               \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name *read_fd_##list_name(int fd) {                                           \
+        return list_name##_read_with(list_fd_read, &fd);                                       \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name##_size_t append_from_fd_##list_name(list_name *list, int fd) {           \
+        return list_name##_append_with(list, list_fd_read, &fd);                               \
+    }
+#else
+#define LIST_DEC_FD_(list_name)
+#define LIST_DEF_FD_(list_name)
+#endif
+
+#define ListDecFile(type, list_name)                                                           \
+    typedef struct                                                                             \
+    {                                                                                          \
+        type *data;                                                                            \
+        list_name##_size_t count;                                                              \
+        void *base;                                                                            \
+        size_t length;                                                                         \
+    } list_name##_mapped;                                                                      \
+    LIST_FN bool save_##list_name(list_name *list, const char *path);                          \
+    LIST_FN list_name##_mapped map_##list_name(const char *path, bool copy_on_write);          \
+    LIST_FN void unmap_##list_name(list_name##_mapped *mapped);                                \
+    LIST_FN bool write_##list_name(list_name *list, FILE *out);                                \
+    LIST_FN list_name *read_##list_name(FILE *in);                                             \
+    LIST_FN list_name##_size_t append_from_stream_##list_name(list_name *list, FILE *in);      \
+    LIST_DEC_FD_(list_name)
+
+/*
+ * save_ writes a list file; map_ opens one without copying the elements.
+ * A mapped list is not a list_name: it cannot grow, and is released with
+ * unmap_. Use view_array_ to run the view operations over it, or
+ * from_array_ to copy it into an ordinary list.
+ *
+ * write_/read_ stream the same format over a FILE * or file descriptor;
+ * read_ trusts the header count only as an upper bound and grows the list
+ * as the payload arrives. append_from_stream_ appends raw elements until
+ * end of stream. Both grow by at least LIST_STREAM_CHUNK_BYTES at a time.
+ */
+#define ListDefFile(type, list_name)                                                                                 \
+    LIST_FN bool save_##list_name(list_name *list, const char *path) {                                               \
+        if (list == NULL) {                                                                                          \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return false;                                                                                            \
+        }                                                                                                            \
+        List_errno e = list_file_save(path, sizeof(type), list->data, (size_t)list->count);                          \
+        set_errno_##list_name(list, e);                                                                              \
+        return e == LIST_OK;                                                                                         \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN list_name##_mapped map_##list_name(const char *path, bool copy_on_write) {                               \
+        list_name##_mapped mapped = {NULL, 0, NULL, 0};                                                              \
+        size_t count = 0;                                                                                            \
+        List_errno e = list_file_map(path, sizeof(type), list_name##_max_capacity(), copy_on_write,                  \
+                                     &mapped.base, &mapped.length, &count);                                          \
+        set_list_errno(e);                                                                                           \
+        if (e == LIST_OK) {                                                                                          \
+            mapped.data = (type *)((unsigned char *)mapped.base + ((List_file_header *)mapped.base)->header_size);   \
+            mapped.count = (list_name##_size_t)count;                                                                \
+        }                                                                                                            \
+        return mapped;                                                                                               \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN void unmap_##list_name(list_name##_mapped *mapped) {                                                     \
+        if (mapped == NULL) {                                                                                        \
+            return;                                                                                                  \
+        }                                                                                                            \
+        list_file_unmap(mapped->base, mapped->length);                                                               \
+        mapped->data = NULL;                                                                                         \
+        mapped->count = 0;                                                                                           \
+        mapped->base = NULL;                                                                                         \
+        mapped->length = 0;                                                                                          \
+    }                                                                                                                \
+                                                                                                                     \
+    static bool list_name##_write_with(list_name *list, List_write_fn write_bytes, void *sink) {                     \
+        if (list == NULL) {                                                                                          \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return false;                                                                                            \
+        }                                                                                                            \
+        List_file_header header = list_file_header(sizeof(type), (size_t)list->count);                               \
+        if (!write_bytes(sink, &header, sizeof(header)) ||                                                           \
+            !write_bytes(sink, list->data, (size_t)list->count * sizeof(type))) {                                    \
+            set_errno_##list_name(list, LIST_IO_ERROR);                                                              \
+            return false;                                                                                            \
+        }                                                                                                            \
+        set_errno_##list_name(list, LIST_OK);                                                                        \
+        return true;                                                                                                 \
+    }                                                                                                                \
+                                                                                                                     \
+    /* Reads whole elements until list holds limit of them or the stream                                             \
+     * ends, growing by LIST_STREAM_CHUNK_BYTES so memory tracks the bytes                                           \
+     * actually received. Returns false if the list could not grow. */                                               \
+    static bool list_name##_fill_with(list_name *list, List_read_fn read_bytes, void *source,                        \
+                                      size_t limit, size_t *partial, bool *failed) {                                 \
+        size_t chunk = LIST_STREAM_CHUNK_BYTES / sizeof(type);                                                       \
+        for (;;) {                                                                                                   \
+            size_t end = (size_t)list->capacity < limit ? (size_t)list->capacity : limit;                            \
+            if ((size_t)list->count == end) {                                                                        \
+                size_t room = limit - (size_t)list->count;                                                           \
+                if (room == 0) {                                                                                     \
+                    return true;                                                                                     \
+                }                                                                                                    \
+                if (!reserve_##list_name(list, (size_t)list->count + (chunk < room ? (chunk ? chunk : 1) : room))) { \
+                    return false;                                                                                    \
+                }                                                                                                    \
+                end = (size_t)list->capacity < limit ? (size_t)list->capacity : limit;                               \
+            }                                                                                                        \
+            size_t want = (end - (size_t)list->count) * sizeof(type) - *partial;                                     \
+            unsigned char *dst = (unsigned char *)(list->data + list->count) + *partial;                             \
+            size_t got = read_bytes(source, dst, want, failed);                                                      \
+            *partial += got;                                                                                         \
+            list->count += (list_name##_size_t)(*partial / sizeof(type));                                            \
+            *partial %= sizeof(type);                                                                                \
+            if (got < want) {                                                                                        \
+                return true;                                                                                         \
+            }                                                                                                        \
+        }                                                                                                            \
+    }                                                                                                                \
+                                                                                                                     \
+    static list_name *list_name##_read_with(List_read_fn read_bytes, void *source) {                                 \
+        List_file_header header;                                                                                     \
+        bool failed = false;                                                                                         \
+        if (read_bytes(source, &header, sizeof(header), &failed) != sizeof(header)) {                                \
+            set_list_errno(failed ? LIST_IO_ERROR : LIST_INVALID_FORMAT);                                            \
+            return NULL;                                                                                             \
+        }                                                                                                            \
+        List_errno e = list_file_check(&header, sizeof(type), list_name##_max_capacity(), UINT64_MAX);               \
+        if (e != LIST_OK) {                                                                                          \
+            set_list_errno(e);                                                                                       \
+            return NULL;                                                                                             \
+        }                                                                                                            \
+        for (uint64_t skip = header.header_size - sizeof(header); skip > 0 && !failed;) {                            \
+            unsigned char scratch[LIST_FILE_HEADER_SIZE];                                                            \
+            size_t n = skip < sizeof(scratch) ? (size_t)skip : sizeof(scratch);                                      \
+            if (read_bytes(source, scratch, n, &failed) != n) {                                                      \
+                set_list_errno(failed ? LIST_IO_ERROR : LIST_INVALID_FORMAT);                                        \
+                return NULL;                                                                                         \
+            }                                                                                                        \
+            skip -= n;                                                                                               \
+        }                                                                                                            \
+        list_name *list = create_##list_name();                                                                      \
+        if (list == NULL) {                                                                                          \
+            set_list_errno(LIST_ALLOCATION_FAILED);                                                                  \
+            return NULL;                                                                                             \
+        }                                                                                                            \
+        size_t partial = 0;                                                                                          \
+        if (!list_name##_fill_with(list, read_bytes, source, (size_t)header.count, &partial, &failed)) {             \
+            destroy_##list_name(list);                                                                               \
+            set_list_errno(LIST_ALLOCATION_FAILED);                                                                  \
+            return NULL;                                                                                             \
+        }                                                                                                            \
+        if (failed || (uint64_t)list->count != header.count) {                                                       \
+            destroy_##list_name(list);                                                                               \
+            set_list_errno(failed ? LIST_IO_ERROR : LIST_INVALID_FORMAT);                                            \
+            return NULL;                                                                                             \
+        }                                                                                                            \
+        set_list_errno(LIST_OK);                                                                                     \
+        return list;                                                                                                 \
+    }                                                                                                                \
+                                                                                                                     \
+    static list_name##_size_t list_name##_append_with(list_name *list, List_read_fn read_bytes, void *source) {      \
+        if (list == NULL) {                                                                                          \
+            set_list_errno(LIST_NOT_EXIST);                                                                          \
+            return 0;                                                                                                \
+        }                                                                                                            \
+        size_t start = (size_t)list->count;                                                                          \
+        size_t partial = 0;                                                                                          \
+        bool failed = false;                                                                                         \
+        if (!list_name##_fill_with(list, read_bytes, source, list_name##_max_capacity(), &partial, &failed)) {       \
+            return (list_name##_size_t)((size_t)list->count - start);                                                \
+        }                                                                                                            \
+        if ((size_t)list->count == list_name##_max_capacity() && !failed) {                                          \
+            unsigned char probe;                                                                                     \
+            if (read_bytes(source, &probe, 1, &failed) != 0) {                                                       \
+                set_errno_##list_name(list, LIST_INVALID_CAPACITY);                                                  \
+                return (list_name##_size_t)((size_t)list->count - start);                                            \
+            }                                                                                                        \
+        }                                                                                                            \
+        set_errno_##list_name(list, failed ? LIST_IO_ERROR : partial != 0 ? LIST_INVALID_FORMAT : LIST_OK);          \
+        return (list_name##_size_t)((size_t)list->count - start);                                                    \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN bool write_##list_name(list_name *list, FILE *out) {                                                     \
+        if (list != NULL && out == NULL) {                                                                           \
+            set_errno_##list_name(list, LIST_IO_ERROR);                                                              \
+            return false;                                                                                            \
+        }                                                                                                            \
+        return list_name##_write_with(list, list_stdio_write, out);                                                  \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN list_name *read_##list_name(FILE *in) {                                                                  \
+        if (in == NULL) {                                                                                            \
+            set_list_errno(LIST_IO_ERROR);                                                                           \
+            return NULL;                                                                                             \
+        }                                                                                                            \
+        return list_name##_read_with(list_stdio_read, in);                                                           \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_FN list_name##_size_t append_from_stream_##list_name(list_name *list, FILE *in) {                           \
+        if (list != NULL && in == NULL) {                                                                            \
+            set_errno_##list_name(list, LIST_IO_ERROR);                                                              \
+            return 0;                                                                                                \
+        }                                                                                                            \
+        return list_name##_append_with(list, list_stdio_read, in);                                                   \
+    }                                                                                                                \
+                                                                                                                     \
+    LIST_DEF_FD_(list_name)
+
+
+/*
+ * Geometric segment table shared by the concurrent and segmented lists:
+ * segment k holds LIST_SEGMENT_FIRST << k elements, so a table of
+ * LIST_SEGMENT_COUNT pointers covers the address space and any index maps
+ * to its segment in O(1).
+ */
+#define LIST_SEGMENT_FIRST ((size_t)64)
+#if SIZE_MAX > 0xFFFFFFFFu
+#define LIST_SEGMENT_COUNT 48
+#else
+#define LIST_SEGMENT_COUNT 24
+#endif
+
+static inline size_t list_segment_locate(size_t index, size_t *offset) {
+    size_t j = index / LIST_SEGMENT_FIRST + 1;
+#if defined(__GNUC__)
+    size_t segment = (size_t)(sizeof(unsigned long long) * CHAR_BIT - 1 - (size_t)__builtin_clzll(j));
+#else
+    size_t segment = list_log2(j);
+#endif
+    *offset = index - LIST_SEGMENT_FIRST * (((size_t)1 << segment) - 1);
+    return segment;
+}
+
+static inline size_t list_segment_size(size_t segment) {
+    return LIST_SEGMENT_FIRST << segment;
+}
+
+/* Index of the first element of `segment`; also the capacity of the segments before it. */
+static inline size_t list_segment_start(size_t segment) {
+    return LIST_SEGMENT_FIRST * (((size_t)1 << segment) - 1);
+}
+
+static inline size_t list_segment_max_capacity(size_t element_size) {
+    size_t slots = list_segment_start(LIST_SEGMENT_COUNT - 1);
+    size_t bytes_limit = SIZE_MAX / element_size / 2;
+    return slots < bytes_limit ? slots : bytes_limit;
+}
+
+
+/*
+ * Append-only list for many producer threads. Slots are reserved with an
+ * atomic compare-and-swap and stored in segments of doubling size that are never
+ * moved, so growth never invalidates a concurrent writer or an element
+ * pointer. Errors go to the thread-local global error code only.
+ */
+#if !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+
+#ifndef LIST_CONCURRENT_BATCH
+#define LIST_CONCURRENT_BATCH 64
+#endif
+
+#define ConcurrentListDec(type, list_name)                                                     \
+    typedef struct                                                                             \
+    {                                                                                          \
+        _Atomic(type *) segments[LIST_SEGMENT_COUNT];                                          \
+        atomic_size_t count;                                                                   \
+    } list_name;                                                                               \
+    typedef struct                                                                             \
+    {                                                                                          \
+        list_name *list;                                                                       \
+        size_t count;                                                                          \
+        type items[LIST_CONCURRENT_BATCH];                                                     \
+    } list_name##_batch;                                                                       \
+    LIST_VAR type list_name##_default_element;                                                 \
+                                                                                               \
+    LIST_FN list_name *create_##list_name(void);                                               \
+    LIST_FN void destroy_##list_name(list_name *list);                                         \
+    LIST_FN bool push_##list_name(list_name *list, type Element);                              \
+    LIST_FN bool append_array_##list_name(list_name *list, type const *arr, size_t len);       \
+    LIST_FN size_t size_##list_name(list_name *list);                                          \
+    LIST_FN type get_##list_name(list_name *list, size_t index);                               \
+    LIST_FN type *at_##list_name(list_name *list, size_t index);                               \
+    LIST_FN void for_each_##list_name(list_name *list, void (*fn)(type));                      \
+    LIST_FN void clear_##list_name(list_name *list);                                           \
+    LIST_FN void batch_init_##list_name(list_name##_batch *batch, list_name *list);            \
+    LIST_FN bool batch_push_##list_name(list_name##_batch *batch, type Element);               \
+    LIST_FN bool batch_flush_##list_name(list_name##_batch *batch);
+
+/*
+ * push_, append_array_ and the batch functions may run from any number of
+ * threads at once. size_ counts reserved slots; get_/at_ of a slot are safe
+ * once the push that filled it is known to have returned (for example after
+ * joining the producers). clear_ and destroy_ need exclusive access.
+ * append_array_ reserves its whole range with one compare-and-swap, so the
+ * elements stay contiguous in index order. The range is checked and its
+ * segments allocated before it is reserved: a push that fails with
+ * LIST_INVALID_CAPACITY or LIST_ALLOCATION_FAILED leaves the count unchanged.
+ */
+#define ConcurrentListDef(type, list_name)                                                                   \
+    static type *list_name##_segment(list_name *list, size_t segment) {                                      \
+        type *data = atomic_load_explicit(&list->segments[segment], memory_order_acquire);                   \
+        if (data != NULL) {                                                                                  \
+            return data;                                                                                     \
+        }                                                                                                    \
+        type *fresh = malloc(list_segment_size(segment) * sizeof(type));                                     \
+        if (fresh == NULL) {                                                                                 \
+            return NULL;                                                                                     \
+        }                                                                                                    \
+        if (atomic_compare_exchange_strong_explicit(&list->segments[segment], &data, fresh,                  \
+                                                    memory_order_acq_rel, memory_order_acquire)) {           \
+            return fresh;                                                                                    \
+        }                                                                                                    \
+        free(fresh);                                                                                         \
+        return data;                                                                                         \
+    }                                                                                                        \
+                                                                                                             \
+    LIST_FN list_name *create_##list_name(void) {                                                            \
+        list_name *list = malloc(sizeof(list_name));                                                         \
+        if (list == NULL) {                                                                                  \
+            set_list_errno(LIST_ALLOCATION_FAILED);                                                          \
+            return NULL;                                                                                     \
+        }                                                                                                    \
+        for (size_t i = 0; i < LIST_SEGMENT_COUNT; i++) {                                                    \
+            atomic_init(&list->segments[i], NULL);                                                           \
+        }                                                                                                    \
+        atomic_init(&list->count, 0);                                                                        \
+        set_list_errno(LIST_OK);                                                                             \
+        return list;                                                                                         \
+    }                                                                                                        \
+                                                                                                             \
+    LIST_FN void clear_##list_name(list_name *list) {                                                        \
+        if (list == NULL) {                                                                                  \
+            set_list_errno(LIST_NOT_EXIST);                                                                  \
+            return;                                                                                          \
+        }                                                                                                    \
+        for (size_t i = 0; i < LIST_SEGMENT_COUNT; i++) {                                                    \
+            free(atomic_exchange_explicit(&list->segments[i], NULL, memory_order_relaxed));                  \
+        }                                                                                                    \
+        atomic_store_explicit(&list->count, 0, memory_order_relaxed);                                        \
+        set_list_errno(LIST_OK);                                                                             \
+    }                                                                                                        \
+                                                                                                             \
+    LIST_FN void destroy_##list_name(list_name *list) {                                                      \
+        if (list == NULL) {                                                                                  \
+            set_list_errno(LIST_NOT_EXIST);                                                                  \
+            return;                                                                                          \
+        }                                                                                                    \
+        clear_##list_name(list);                                                                             \
+        free(list);                                                                                          \
+    }                                                                                                        \
+                                                                                                             \
+    LIST_FN bool append_array_##list_name(list_name *list, type const *arr, size_t len) {                    \
+        if (list == NULL) {                                                                                  \
+            set_list_errno(LIST_NOT_EXIST);                                                                  \
+            return false;                                                                                    \
+        }                                                                                                    \
+        if (arr == NULL && len > 0) {                                                                        \
+            set_list_errno(LIST_INVALID_RAW_ARRAY);                                                          \
+            return false;                                                                                    \
+        }                                                                                                    \
+        if (len == 0) {                                                                                      \
+            set_list_errno(LIST_OK);                                                                         \
+            return true;                                                                                     \
+        }                                                                                                    \
+        size_t max_capacity = list_segment_max_capacity(sizeof(type));                                       \
+        if (len > max_capacity) {                                                                            \
+            set_list_errno(LIST_INVALID_CAPACITY);                                                           \
+            return false;                                                                                    \
+        }                                                                                                    \
+        /* Check the range and allocate its segments before publishing it, so a failure reserves nothing. */ \
+        size_t start = atomic_load_explicit(&list->count, memory_order_relaxed);                             \
+        do {                                                                                                 \
+            if (start > max_capacity - len) {                                                                \
+                set_list_errno(LIST_INVALID_CAPACITY);                                                       \
+                return false;                                                                                \
+            }                                                                                                \
+            size_t last_offset;                                                                              \
+            size_t last = list_segment_locate(start + len - 1, &last_offset);                                \
+            for (size_t segment = list_segment_locate(start, &last_offset); segment <= last; segment++) {    \
+                if (list_name##_segment(list, segment) == NULL) {                                            \
+                    set_list_errno(LIST_ALLOCATION_FAILED);                                                  \
+                    return false;                                                                            \
+                }                                                                                            \
+            }                                                                                                \
+        } while (!atomic_compare_exchange_weak_explicit(&list->count, &start, start + len,                   \
+                                                        memory_order_release, memory_order_relaxed));        \
+        size_t offset;                                                                                       \
+        size_t segment = list_segment_locate(start, &offset);                                                \
+        while (len > 0) {                                                                                    \
+            type *data = atomic_load_explicit(&list->segments[segment], memory_order_acquire);               \
+            size_t n = list_segment_size(segment) - offset;                                                  \
+            if (n > len) {                                                                                   \
+                n = len;                                                                                     \
+            }                                                                                                \
+            memcpy(data + offset, arr, n * sizeof(type));                                                    \
+            arr += n;                                                                                        \
+            len -= n;                                                                                        \
+            segment++;                                                                                       \
+            offset = 0;                                                                                      \
+        }                                                                                                    \
+        set_list_errno(LIST_OK);                                                                             \
+        return true;                                                                                         \
+    }                                                                                                        \
+                                                                                                             \
+    LIST_FN bool push_##list_name(list_name *list, type Element) {                                           \
+        return append_array_##list_name(list, &Element, 1);                                                  \
+    }                                                                                                        \
+                                                                                                             \
+    LIST_FN size_t size_##list_name(list_name *list) {                                                       \
+        if (list == NULL) {                                                                                  \
+            set_list_errno(LIST_NOT_EXIST);                                                                  \
+            return 0;                                                                                        \
+        }                                                                                                    \
+        return atomic_load_explicit(&list->count, memory_order_acquire);                                     \
+    }                                                                                                        \
+                                                                                                             \
+    LIST_FN type *at_##list_name(list_name *list, size_t index) {                                            \
+        if (list == NULL) {                                                                                  \
+            set_list_errno(LIST_NOT_EXIST);                                                                  \
+            return NULL;                                                                                     \
+        }                                                                                                    \
+        if (index >= atomic_load_explicit(&list->count, memory_order_acquire)) {                             \
+            set_list_errno(LIST_OUT_OF_RANGE);                                                               \
+            return NULL;                                                                                     \
+        }                                                                                                    \
+        size_t offset;                                                                                       \
+        size_t segment = list_segment_locate(index, &offset);                                                \
+        type *data = atomic_load_explicit(&list->segments[segment], memory_order_acquire);                   \
+        if (data == NULL) {                                                                                  \
+            set_list_errno(LIST_OUT_OF_RANGE);                                                               \
+            return NULL;                                                                                     \
+        }                                                                                                    \
+        return data + offset;                                                                                \
+    }                                                                                                        \
+                                                                                                             \
+    LIST_FN type get_##list_name(list_name *list, size_t index) {                                            \
+        type *slot = at_##list_name(list, index);                                                            \
+        return slot == NULL ? list_name##_default_element : *slot;                                           \
+    }                                                                                                        \
+                                                                                                             \
+    LIST_FN void for_each_##list_name(list_name *list, void (*fn)(type)) {                                   \
+        if (list == NULL) {                                                                                  \
+            set_list_errno(LIST_NOT_EXIST);                                                                  \
+            return;                                                                                          \
+        }                                                                                                    \
+        if (fn == NULL) {                                                                                    \
+            set_list_errno(LIST_INVALID_PRINTFN);                                                            \
+            return;                                                                                          \
+        }                                                                                                    \
+        size_t remaining = atomic_load_explicit(&list->count, memory_order_acquire);                         \
+        for (size_t segment = 0; remaining > 0 && segment < LIST_SEGMENT_COUNT; segment++) {                 \
+            type *data = atomic_load_explicit(&list->segments[segment], memory_order_acquire);               \
+            size_t n = list_segment_size(segment);                                                           \
+            if (n > remaining) {                                                                             \
+                n = remaining;                                                                               \
+            }                                                                                                \
+            if (data != NULL) {                                                                              \
+                for (size_t i = 0; i < n; i++) {                                                             \
+                    fn(data[i]);                                                                             \
+                }                                                                                            \
+            }                                                                                                \
+            remaining -= n;                                                                                  \
+        }                                                                                                    \
+        set_list_errno(LIST_OK);                                                                             \
+    }                                                                                                        \
+                                                                                                             \
+    LIST_FN void batch_init_##list_name(list_name##_batch *batch, list_name *list) {                         \
+        batch->list = list;                                                                                  \
+        batch->count = 0;                                                                                    \
+    }                                                                                                        \
+                                                                                                             \
+    LIST_FN bool batch_flush_##list_name(list_name##_batch *batch) {                                         \
+        size_t n = batch->count;                                                                             \
+        batch->count = 0;                                                                                    \
+        return append_array_##list_name(batch->list, batch->items, n);                                       \
+    }                                                                                                        \
+                                                                                                             \
+    LIST_FN bool batch_push_##list_name(list_name##_batch *batch, type Element) {                            \
+        batch->items[batch->count++] = Element;                                                              \
+        if (batch->count == LIST_CONCURRENT_BATCH) {                                                         \
+            return batch_flush_##list_name(batch);                                                           \
+        }                                                                                                    \
+        return true;                                                                                         \
+    }
+#endif
+
+
+/*
+ * Parallel operations over a list's buffer on a reusable pthread pool. Work
+ * is cut into chunks whose byte size is a multiple of a cache line, the
+ * calling thread works alongside the pool, and lists shorter than
+ * LIST_PARALLEL_THRESHOLD elements are processed sequentially.
+ */
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__STDC_NO_ATOMICS__) && !defined(C_LIST_NO_PARALLEL)
+#define LIST_HAVE_PARALLEL
+#include <pthread.h>
+#include <unistd.h>
+
+#ifndef LIST_PARALLEL_THRESHOLD
+#define LIST_PARALLEL_THRESHOLD 16384
+#endif
+
+#define LIST_CACHE_LINE 64
+
+typedef void (*List_task_fn)(void *ctx, size_t chunk);
+
+typedef struct List_pool {
+    pthread_t *threads;
+    size_t thread_count;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+    List_task_fn task;
+    void *ctx;
+    size_t chunks;
+    size_t next;
+    size_t pending;
+    bool stop;
+} List_pool;
+
+extern _Atomic(List_pool *) list_default_pool;
+
+static inline void *list_pool_worker(void *arg) {
+    List_pool *pool = arg;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->next >= pool->chunks) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stop) {
+            break;
+        }
+        size_t chunk = pool->next++;
+        List_task_fn task = pool->task;
+        void *ctx = pool->ctx;
+        pthread_mutex_unlock(&pool->lock);
+        task(ctx, chunk);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_broadcast(&pool->idle);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static inline void list_pool_destroy(List_pool *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_cond_destroy(&pool->idle);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
+
+/* `threads` workers besides the caller; 0 means one per online CPU, minus the caller. */
+static inline List_pool *list_pool_create(size_t threads) {
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 1 ? (size_t)cpus - 1 : 0;
+    }
+    List_pool *pool = calloc(1, sizeof(List_pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->threads = threads ? malloc(threads * sizeof(pthread_t)) : NULL;
+    if (threads && pool->threads == NULL) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+    for (; pool->thread_count < threads; pool->thread_count++) {
+        if (pthread_create(&pool->threads[pool->thread_count], NULL, list_pool_worker, pool) != 0) {
+            break;
+        }
+    }
+    return pool;
+}
+
+/* The shared pool used when a parallel_ function is given NULL; created on first use. */
+static inline List_pool *list_pool_default(void) {
+    List_pool *pool = atomic_load_explicit(&list_default_pool, memory_order_acquire);
+    if (pool != NULL) {
+        return pool;
+    }
+    List_pool *fresh = list_pool_create(0);
+    if (fresh == NULL) {
+        return NULL;
+    }
+    if (atomic_compare_exchange_strong_explicit(&list_default_pool, &pool, fresh,
+                                                memory_order_acq_rel, memory_order_acquire)) {
+        return fresh;
+    }
+    list_pool_destroy(fresh);
+    return pool;
+}
+
+/*
+ * Runs task(ctx, 0 .. chunks-1) and returns when all chunks are done. Calls
+ * on the same pool from different threads take turns; a task must not start
+ * another parallel operation on its own pool.
+ */
+static inline void list_pool_run(List_pool *pool, List_task_fn task, void *ctx, size_t chunks) {
+    if (pool == NULL || pool->thread_count == 0 || chunks < 2) {
+        for (size_t i = 0; i < chunks; i++) {
+            task(ctx, i);
+        }
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending != 0) {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pool->task = task;
+    pool->ctx = ctx;
+    pool->chunks = chunks;
+    pool->next = 0;
+    pool->pending = chunks;
+    pthread_cond_broadcast(&pool->wake);
+    while (pool->next < pool->chunks) {
+        size_t chunk = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+        task(ctx, chunk);
+        pthread_mutex_lock(&pool->lock);
+        --pool->pending;
+    }
+    while (pool->pending != 0) {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pthread_cond_broadcast(&pool->idle);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Elements per chunk: about four chunks per thread, a whole number of cache lines each. */
+static inline size_t list_parallel_chunk(List_pool *pool, size_t n, size_t element_size) {
+    if (pool == NULL || pool->thread_count == 0 || n < LIST_PARALLEL_THRESHOLD) {
+        return n ? n : 1;
+    }
+    size_t line = LIST_CACHE_LINE;
+    size_t step = 1;
+    while ((step * element_size) % line != 0 && step < line) {
+        step++;
+    }
+    size_t chunk = n / ((pool->thread_count + 1) * 4);
+    chunk = (chunk + step - 1) / step * step;
+    return chunk ? chunk : step;
+}
+
+#define LIST_INIT_PARALLEL_ _Atomic(List_pool *) list_default_pool = NULL;
+
+#define ListDecParallel(type, list_name)                                                             \
+    LIST_FN void parallel_for_each_##list_name(list_name *list, void (*fn)(type), List_pool *pool);  \
+    LIST_FN list_name *parallel_map_##list_name(list_name *list, type (*fn)(type), List_pool *pool); \
+    LIST_FN type parallel_reduce_##list_name(list_name *list, type init, type (*combine)(type, type), List_pool *pool);
+
+/*
+ * pool may be NULL for the shared default pool. parallel_reduce_ reduces
+ * each chunk from its first element and then folds the chunk results into
+ * init in order, so `combine` must be associative.
+ */
+#define ListDefParallel(type, list_name)                                                                                 \
+    typedef struct                                                                                                       \
+    {                                                                                                                    \
+        type *src;                                                                                                       \
+        type *dst;                                                                                                       \
+        size_t count;                                                                                                    \
+        size_t chunk;                                                                                                    \
+        void (*each)(type);                                                                                              \
+        type (*map)(type);                                                                                               \
+        type (*combine)(type, type);                                                                                     \
+    } list_name##_parallel_job;                                                                                          \
+                                                                                                                         \
+    static void list_name##_parallel_each_task(void *ctx, size_t chunk) {                                                \
+        list_name##_parallel_job *job = ctx;                                                                             \
+        size_t start = chunk * job->chunk;                                                                               \
+        size_t end = start + job->chunk < job->count ? start + job->chunk : job->count;                                  \
+        for (size_t i = start; i < end; i++) {                                                                           \
+            job->each(job->src[i]);                                                                                      \
+        }                                                                                                                \
+    }                                                                                                                    \
+                                                                                                                         \
+    static void list_name##_parallel_map_task(void *ctx, size_t chunk) {                                                 \
+        list_name##_parallel_job *job = ctx;                                                                             \
+        size_t start = chunk * job->chunk;                                                                               \
+        size_t end = start + job->chunk < job->count ? start + job->chunk : job->count;                                  \
+        for (size_t i = start; i < end; i++) {                                                                           \
+            job->dst[i] = job->map(job->src[i]);                                                                         \
+        }                                                                                                                \
+    }                                                                                                                    \
+                                                                                                                         \
+    static void list_name##_parallel_reduce_task(void *ctx, size_t chunk) {                                              \
+        list_name##_parallel_job *job = ctx;                                                                             \
+        size_t start = chunk * job->chunk;                                                                               \
+        size_t end = start + job->chunk < job->count ? start + job->chunk : job->count;                                  \
+        type acc = job->src[start];                                                                                      \
+        for (size_t i = start + 1; i < end; i++) {                                                                       \
+            acc = job->combine(acc, job->src[i]);                                                                        \
+        }                                                                                                                \
+        job->dst[chunk] = acc;                                                                                           \
+    }                                                                                                                    \
+                                                                                                                         \
+    LIST_FN void parallel_for_each_##list_name(list_name *list, void (*fn)(type), List_pool *pool) {                     \
+        if (list == NULL) {                                                                                              \
+            set_list_errno(LIST_NOT_EXIST);                                                                              \
+            return;                                                                                                      \
+        }                                                                                                                \
+        if (fn == NULL) {                                                                                                \
+            set_errno_##list_name(list, LIST_INVALID_PRINTFN);                                                           \
+            return;                                                                                                      \
+        }                                                                                                                \
+        if (pool == NULL && (size_t)list->count >= LIST_PARALLEL_THRESHOLD) {                                            \
+            pool = list_pool_default();                                                                                  \
+        }                                                                                                                \
+        list_name##_parallel_job job = {list->data, NULL, (size_t)list->count, 0, fn, NULL, NULL};                       \
+        job.chunk = list_parallel_chunk(pool, job.count, sizeof(type));                                                  \
+        list_pool_run(pool, list_name##_parallel_each_task, &job, (job.count + job.chunk - 1) / job.chunk);              \
+        set_errno_##list_name(list, LIST_OK);                                                                            \
+    }                                                                                                                    \
+                                                                                                                         \
+    LIST_FN list_name *parallel_map_##list_name(list_name *list, type (*fn)(type), List_pool *pool) {                    \
+        if (list == NULL) {                                                                                              \
+            set_list_errno(LIST_NOT_EXIST);                                                                              \
+            return NULL;                                                                                                 \
+        }                                                                                                                \
+        if (fn == NULL) {                                                                                                \
+            set_errno_##list_name(list, LIST_INVALID_PRINTFN);                                                           \
+            return NULL;                                                                                                 \
+        }                                                                                                                \
+        list_name *result = create_##list_name();                                                                        \
+        if (result == NULL || (list->count > 0 && !resize_##list_name(result, list->count))) {                           \
+            destroy_##list_name(result);                                                                                 \
+            set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                                                         \
+            return NULL;                                                                                                 \
+        }                                                                                                                \
+        if (pool == NULL && (size_t)list->count >= LIST_PARALLEL_THRESHOLD) {                                            \
+            pool = list_pool_default();                                                                                  \
+        }                                                                                                                \
+        list_name##_parallel_job job = {list->data, result->data, (size_t)list->count, 0, NULL, fn, NULL};               \
+        job.chunk = list_parallel_chunk(pool, job.count, sizeof(type));                                                  \
+        list_pool_run(pool, list_name##_parallel_map_task, &job, (job.count + job.chunk - 1) / job.chunk);               \
+        result->count = list->count;                                                                                     \
+        set_errno_##list_name(list, LIST_OK);                                                                            \
+        return result;                                                                                                   \
+    }                                                                                                                    \
+                                                                                                                         \
+    LIST_FN type parallel_reduce_##list_name(list_name *list, type init, type (*combine)(type, type), List_pool *pool) { \
+        if (list == NULL) {                                                                                              \
+            set_list_errno(LIST_NOT_EXIST);                                                                              \
+            return init;                                                                                                 \
+        }                                                                                                                \
+        if (combine == NULL) {                                                                                           \
+            set_errno_##list_name(list, LIST_INVALID_PRINTFN);                                                           \
+            return init;                                                                                                 \
+        }                                                                                                                \
+        if (pool == NULL && (size_t)list->count >= LIST_PARALLEL_THRESHOLD) {                                            \
+            pool = list_pool_default();                                                                                  \
+        }                                                                                                                \
+        list_name##_parallel_job job = {list->data, NULL, (size_t)list->count, 0, NULL, NULL, combine};                  \
+        job.chunk = list_parallel_chunk(pool, job.count, sizeof(type));                                                  \
+        size_t chunks = (job.count + job.chunk - 1) / job.chunk;                                                         \
+        type single;                                                                                                     \
+        job.dst = chunks > 1 ? malloc(chunks * sizeof(type)) : &single;                                                  \
+        if (job.dst == NULL) {                                                                                           \
+            job.chunk = job.count;                                                                                       \
+            chunks = job.count ? 1 : 0;                                                                                  \
+            job.dst = &single;                                                                                           \
+        }                                                                                                                \
+        list_pool_run(pool, list_name##_parallel_reduce_task, &job, chunks);                                             \
+        type result = init;                                                                                              \
+        for (size_t i = 0; i < chunks; i++) {                                                                            \
+            result = combine(result, job.dst[i]);                                                                        \
+        }                                                                                                                \
+        if (job.dst != &single) {                                                                                        \
+            free(job.dst);                                                                                               \
+        }                                                                                                                \
+        set_errno_##list_name(list, LIST_OK);                                                                            \
+        return result;                                                                                                   \
+    }
+
+#define ListDecParallelSort(type, list_name) \
+    LIST_FN void parallel_sort_##list_name(list_name *list, List_pool *pool);
+
+/*
+ * Sorts chunks in parallel with the list's sort_ algorithm, then merges
+ * runs pairwise, one parallel pass per doubling. Needs ListDefOrdered (or
+ * ListDefOrderedInt) for the same list, with the same LESS.
+ */
+#define ListDefParallelSort(type, list_name, LESS)                                                                 \
+    typedef struct                                                                                                 \
+    {                                                                                                              \
+        type *src;                                                                                                 \
+        type *dst;                                                                                                 \
+        size_t count;                                                                                              \
+        size_t width;                                                                                              \
+    } list_name##_parallel_sort_job;                                                                               \
+                                                                                                                   \
+    static void list_name##_parallel_sort_task(void *ctx, size_t chunk) {                                          \
+        list_name##_parallel_sort_job *job = ctx;                                                                  \
+        size_t start = chunk * job->width;                                                                         \
+        size_t len = start + job->width < job->count ? job->width : job->count - start;                            \
+        list_name##_sort_data(job->src + start, len);                                                              \
+    }                                                                                                              \
+                                                                                                                   \
+    static void list_name##_parallel_merge_task(void *ctx, size_t chunk) {                                         \
+        list_name##_parallel_sort_job *job = ctx;                                                                  \
+        size_t start = chunk * 2 * job->width;                                                                     \
+        size_t mid = start + job->width < job->count ? start + job->width : job->count;                            \
+        size_t end = mid + job->width < job->count ? mid + job->width : job->count;                                \
+        size_t i = start, j = mid, k = start;                                                                      \
+        while (i < mid && j < end) {                                                                               \
+            job->dst[k++] = LESS(job->src[j], job->src[i]) ? job->src[j++] : job->src[i++];                        \
+        }                                                                                                          \
+        memcpy(job->dst + k, job->src + i, (mid - i) * sizeof(type));                                              \
+        k += mid - i;                                                                                              \
+        memcpy(job->dst + k, job->src + j, (end - j) * sizeof(type));                                              \
+    }                                                                                                              \
+                                                                                                                   \
+    LIST_FN void parallel_sort_##list_name(list_name *list, List_pool *pool) {                                     \
+        if (list == NULL) {                                                                                        \
+            set_list_errno(LIST_NOT_EXIST);                                                                        \
+            return;                                                                                                \
+        }                                                                                                          \
+        size_t n = (size_t)list->count;                                                                            \
+        if (pool == NULL && n >= LIST_PARALLEL_THRESHOLD) {                                                        \
+            pool = list_pool_default();                                                                            \
+        }                                                                                                          \
+        size_t width = list_parallel_chunk(pool, n, sizeof(type));                                                 \
+        type *scratch = width < n ? malloc(n * sizeof(type)) : NULL;                                               \
+        if (scratch == NULL) {                                                                                     \
+            list_name##_sort_data(list->data, n);                                                                  \
+            set_errno_##list_name(list, LIST_OK);                                                                  \
+            return;                                                                                                \
+        }                                                                                                          \
+        list_name##_parallel_sort_job job = {list->data, scratch, n, width};                                       \
+        list_pool_run(pool, list_name##_parallel_sort_task, &job, (n + width - 1) / width);                        \
+        for (; job.width < n; job.width *= 2) {                                                                    \
+            list_pool_run(pool, list_name##_parallel_merge_task, &job, (n + 2 * job.width - 1) / (2 * job.width)); \
+            type *tmp = job.src;                                                                                   \
+            job.src = job.dst;                                                                                     \
+            job.dst = tmp;                                                                                         \
+        }                                                                                                          \
+        if (job.src != list->data) {                                                                               \
+            memcpy(list->data, job.src, n * sizeof(type));                                                         \
+        }                                                                                                          \
+        free(scratch);                                                                                             \
+        set_errno_##list_name(list, LIST_OK);                                                                      \
+    }
+#else
+#define LIST_INIT_PARALLEL_
+#endif
+
+
+/*
+ * Double-ended queue over a circular buffer. The capacity is a power of two,
+ * so the slot of element i is (head + i) & (capacity - 1) and both ends push
+ * and pop in O(1). Errors follow the list model: per-deque and global codes.
+ */
+#define DequeDec(type, list_name)                                                              \
+    typedef struct                                                                             \
+    {                                                                                          \
+        size_t capacity;                                                                       \
+        size_t count;                                                                          \
+        size_t head;                                                                           \
+        type *data;                                                                            \
+        List_errno err;                                                                        \
+    } list_name;                                                                               \
+    LIST_VAR type list_name##_default_element;                                                 \
+    LIST_STATS_DECLARE_(list_name)                                                             \
+                                                                                               \
+    LIST_FN List_errno get_errno_##list_name(list_name *deque);                                \
+    LIST_FN void set_errno_##list_name(list_name *deque, List_errno e);                        \
+    LIST_FN list_name *create_##list_name(void);                                               \
+    LIST_FN void destroy_##list_name(list_name *deque);                                        \
+    LIST_FN bool reserve_##list_name(list_name *deque, size_t capacity);                       \
+    LIST_FN bool push_back_##list_name(list_name *deque, type Element);                        \
+    LIST_FN bool push_front_##list_name(list_name *deque, type Element);                       \
+    LIST_FN type pop_back_##list_name(list_name *deque);                                       \
+    LIST_FN type pop_front_##list_name(list_name *deque);                                      \
+    LIST_FN type front_##list_name(list_name *deque);                                          \
+    LIST_FN type back_##list_name(list_name *deque);                                           \
+    LIST_FN type get_##list_name(list_name *deque, size_t index);                              \
+    LIST_FN bool set_##list_name(list_name *deque, size_t index, type Element);                \
+    LIST_FN size_t size_##list_name(list_name *deque);                                         \
+    LIST_FN size_t capacity_##list_name(list_name *deque);                                     \
+    LIST_FN bool empty_##list_name(list_name *deque);                                          \
+    LIST_FN void clear_##list_name(list_name *deque);                                          \
+    LIST_FN void print_##list_name(list_name *deque, void (*printElement)(type));              \
+    LIST_FN List_stats get_stats_##list_name(void);                                            \
+    LIST_FN void reset_stats_##list_name(void);                                                \
+    LIST_FN void dump_stats_##list_name(FILE *out);
+
+#define DequeDef(type, list_name)                                                                  \
+    LIST_STATS_DEFINE_(list_name)                                                                  \
+                                                                                                   \
+    LIST_FN List_errno get_errno_##list_name(list_name *deque) {                                   \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return LIST_NOT_EXIST;                                                                 \
+        }                                                                                          \
+        List_errno err = deque->err;                                                               \
+        deque->err = LIST_OK;                                                                      \
+        set_list_errno(LIST_OK);                                                                   \
+        return err;                                                                                \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN void set_errno_##list_name(list_name *deque, List_errno e) {                           \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return;                                                                                \
+        }                                                                                          \
+        list_store_errno(&deque->err, e);                                                          \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN list_name *create_##list_name(void) {                                                  \
+        list_name *deque = malloc(sizeof(list_name));                                              \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_ALLOCATION_FAILED);                                                \
+            return NULL;                                                                           \
+        }                                                                                          \
+        deque->capacity = 0;                                                                       \
+        deque->count = 0;                                                                          \
+        deque->head = 0;                                                                           \
+        deque->data = NULL;                                                                        \
+        deque->err = LIST_OK;                                                                      \
+        set_list_errno(LIST_OK);                                                                   \
+        return deque;                                                                              \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN void clear_##list_name(list_name *deque) {                                             \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return;                                                                                \
+        }                                                                                          \
+        LIST_STAT_RESIZE_(list_name, sizeof(type) * deque->capacity, 0);                           \
+        FREE_ARRAY(type, deque->data, deque->capacity);                                            \
+        deque->capacity = 0;                                                                       \
+        deque->count = 0;                                                                          \
+        deque->head = 0;                                                                           \
+        deque->data = NULL;                                                                        \
+        set_errno_##list_name(deque, LIST_OK);                                                     \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN void destroy_##list_name(list_name *deque) {                                           \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return;                                                                                \
+        }                                                                                          \
+        clear_##list_name(deque);                                                                  \
+        free(deque);                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Moves the elements, in order, to the start of a buffer of new_capacity (a power of two). */ \
+    static bool list_name##_relocate(list_name *deque, size_t new_capacity) {                      \
+        type *data = CHANGE_ARRAY(type, NULL, 0, new_capacity);                                    \
+        if (data == NULL) {                                                                        \
+            set_errno_##list_name(deque, LIST_ALLOCATION_FAILED);                                  \
+            return false;                                                                          \
+        }                                                                                          \
+        size_t first = deque->capacity - deque->head;                                              \
+        if (first > deque->count) {                                                                \
+            first = deque->count;                                                                  \
+        }                                                                                          \
+        if (deque->count > 0) {                                                                    \
+            memcpy(data, deque->data + deque->head, first * sizeof(type));                         \
+            memcpy(data + first, deque->data, (deque->count - first) * sizeof(type));              \
+        }                                                                                          \
+        LIST_STAT_(list_name, reallocations, 1);                                                   \
+        LIST_STAT_(list_name, bytes_copied, sizeof(type) * deque->count);                          \
+        LIST_STAT_RESIZE_(list_name, sizeof(type) * deque->capacity, sizeof(type) * new_capacity); \
+        FREE_ARRAY(type, deque->data, deque->capacity);                                            \
+        deque->data = data;                                                                        \
+        deque->capacity = new_capacity;                                                            \
+        deque->head = 0;                                                                           \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN bool reserve_##list_name(list_name *deque, size_t capacity) {                          \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return false;                                                                          \
+        }                                                                                          \
+        if (capacity > deque->capacity) {                                                          \
+            size_t max_capacity = list_capacity_limit(SIZE_MAX / 2, sizeof(type));                 \
+            size_t new_capacity = 8;                                                               \
+            while (new_capacity < capacity && new_capacity <= max_capacity / 2) {                  \
+                new_capacity *= 2;                                                                 \
+            }                                                                                      \
+            if (new_capacity < capacity) {                                                         \
+                set_errno_##list_name(deque, LIST_INVALID_CAPACITY);                               \
+                return false;                                                                      \
+            }                                                                                      \
+            if (!list_name##_relocate(deque, new_capacity)) {                                      \
+                return false;                                                                      \
+            }                                                                                      \
+        }                                                                                          \
+        set_errno_##list_name(deque, LIST_OK);                                                     \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    /* Halves the buffer once it is at most a quarter full. */                                     \
+    static void list_name##_maybe_shrink(list_name *deque) {                                       \
+        if (deque->capacity > 8 && deque->count <= deque->capacity / 4) {                          \
+            list_name##_relocate(deque, deque->capacity / 2);                                      \
+        }                                                                                          \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN bool push_back_##list_name(list_name *deque, type Element) {                           \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return false;                                                                          \
+        }                                                                                          \
+        if (deque->count == deque->capacity && !reserve_##list_name(deque, deque->count + 1)) {    \
+            return false;                                                                          \
+        }                                                                                          \
+        deque->data[(deque->head + deque->count) & (deque->capacity - 1)] = Element;               \
+        deque->count++;                                                                            \
+        set_errno_##list_name(deque, LIST_OK);                                                     \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN bool push_front_##list_name(list_name *deque, type Element) {                          \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return false;                                                                          \
+        }                                                                                          \
+        if (deque->count == deque->capacity && !reserve_##list_name(deque, deque->count + 1)) {    \
+            return false;                                                                          \
+        }                                                                                          \
+        deque->head = (deque->head - 1) & (deque->capacity - 1);                                   \
+        deque->data[deque->head] = Element;                                                        \
+        deque->count++;                                                                            \
+        set_errno_##list_name(deque, LIST_OK);                                                     \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN type pop_back_##list_name(list_name *deque) {                                          \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return list_name##_default_element;                                                    \
+        }                                                                                          \
+        if (deque->count == 0) {                                                                   \
+            set_errno_##list_name(deque, LIST_EMPTY);                                              \
+            return list_name##_default_element;                                                    \
+        }                                                                                          \
+        deque->count--;                                                                            \
+        type Element = deque->data[(deque->head + deque->count) & (deque->capacity - 1)];          \
+        list_name##_maybe_shrink(deque);                                                           \
+        set_errno_##list_name(deque, LIST_OK);                                                     \
+        return Element;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN type pop_front_##list_name(list_name *deque) {                                         \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return list_name##_default_element;                                                    \
+        }                                                                                          \
+        if (deque->count == 0) {                                                                   \
+            set_errno_##list_name(deque, LIST_EMPTY);                                              \
+            return list_name##_default_element;                                                    \
+        }                                                                                          \
+        type Element = deque->data[deque->head];                                                   \
+        deque->head = (deque->head + 1) & (deque->capacity - 1);                                   \
+        deque->count--;                                                                            \
+        list_name##_maybe_shrink(deque);                                                           \
+        set_errno_##list_name(deque, LIST_OK);                                                     \
+        return Element;                                                                            \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN type get_##list_name(list_name *deque, size_t index) {                                 \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return list_name##_default_element;                                                    \
+        }                                                                                          \
+        if (index >= deque->count) {                                                               \
+            set_errno_##list_name(deque, LIST_OUT_OF_RANGE);                                       \
+            return list_name##_default_element;                                                    \
+        }                                                                                          \
+        set_errno_##list_name(deque, LIST_OK);                                                     \
+        return deque->data[(deque->head + index) & (deque->capacity - 1)];                         \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN bool set_##list_name(list_name *deque, size_t index, type Element) {                   \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return false;                                                                          \
+        }                                                                                          \
+        if (index >= deque->count) {                                                               \
+            set_errno_##list_name(deque, LIST_OUT_OF_RANGE);                                       \
+            return false;                                                                          \
+        }                                                                                          \
+        deque->data[(deque->head + index) & (deque->capacity - 1)] = Element;                      \
+        set_errno_##list_name(deque, LIST_OK);                                                     \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN type front_##list_name(list_name *deque) {                                             \
+        if (deque != NULL && deque->count == 0) {                                                  \
+            set_errno_##list_name(deque, LIST_EMPTY);                                              \
+            return list_name##_default_element;                                                    \
+        }                                                                                          \
+        return get_##list_name(deque, 0);                                                          \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN type back_##list_name(list_name *deque) {                                              \
+        if (deque != NULL && deque->count == 0) {                                                  \
+            set_errno_##list_name(deque, LIST_EMPTY);                                              \
+            return list_name##_default_element;                                                    \
+        }                                                                                          \
+        return get_##list_name(deque, deque == NULL ? 0 : deque->count - 1);                       \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN size_t size_##list_name(list_name *deque) {                                            \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return 0;                                                                              \
+        }                                                                                          \
+        set_errno_##list_name(deque, LIST_OK);                                                     \
+        return deque->count;                                                                       \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN size_t capacity_##list_name(list_name *deque) {                                        \
+        if (deque == NULL) {                                                                       \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return 0;                                                                              \
+        }                                                                                          \
+        set_errno_##list_name(deque, LIST_OK);                                                     \
+        return deque->capacity;                                                                    \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN bool empty_##list_name(list_name *deque) {                                             \
+        return size_##list_name(deque) == 0;                                                       \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN void print_##list_name(list_name *deque, void (*printElement)(type)) {                 \
+        if (deque == NULL) {                                                                       \
+            printf("NULL\n");                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                        \
+            return;                                                                                \
+        }                                                                                          \
+        if (printElement == NULL) {                                                                \
+            set_errno_##list_name(deque, LIST_INVALID_PRINTFN);                                    \
+            return;                                                                                \
+        }                                                                                          \
+        printf("[");                                                                               \
+        for (size_t i = 0; i < deque->count; i++) {                                                \
+            printElement(deque->data[(deque->head + i) & (deque->capacity - 1)]);                  \
+            if (i < deque->count - 1) {                                                            \
+                printf(",");                                                                       \
+            }                                                                                      \
+        }                                                                                          \
+        printf("]\n");                                                                             \
+        set_errno_##list_name(deque, LIST_OK);                                                     \
+    }                                                                                              \
+                                                                                                   \
+    LIST_FN List_stats get_stats_##list_name(void) { return LIST_STATS_GET_(list_name); }          \
+                                                                                                   \
+    LIST_FN void reset_stats_##list_name(void) { LIST_STATS_RESET_(list_name); }                   \
+                                                                                                   \
+    LIST_FN void dump_stats_##list_name(FILE *out) {                                               \
+        list_stats_dump(#list_name, LIST_STATS_GET_(list_name), out == NULL ? stderr : out);       \
+    }
+
+
+/*
+ * Segmented companion of a ListDec'd list. Elements live in the geometric
+ * segment table, so growing adds a segment instead of reallocating and
+ * copying, and element addresses stay valid until the element is popped.
+ * Indexing is O(1): one bit scan to find the segment.
+ */
+#define SegmentedListDec(type, list_name)                                                                      \
+    typedef struct {                                                                                           \
+        type *segments[LIST_SEGMENT_COUNT];                                                                    \
+        size_t count;                                                                                          \
+        size_t allocated;                                                                                      \
+        List_errno err;                                                                                        \
+    } list_name##Segmented;                                                                                    \
+                                                                                                               \
+    LIST_FN List_errno get_errno_##list_name##Segmented(list_name##Segmented *list);                           \
+    LIST_FN list_name##Segmented *create_##list_name##Segmented(void);                                         \
+    LIST_FN void destroy_##list_name##Segmented(list_name##Segmented *list);                                   \
+    LIST_FN void clear_##list_name##Segmented(list_name##Segmented *list);                                     \
+    LIST_FN bool push_##list_name##Segmented(list_name##Segmented *list, type Element);                        \
+    LIST_FN type pop_##list_name##Segmented(list_name##Segmented *list);                                       \
+    LIST_FN bool append_array_##list_name##Segmented(list_name##Segmented *list, type const *arr, size_t len); \
+    LIST_FN type get_##list_name##Segmented(list_name##Segmented *list, size_t index);                         \
+    LIST_FN bool set_##list_name##Segmented(list_name##Segmented *list, size_t index, type Element);           \
+    LIST_FN type *at_##list_name##Segmented(list_name##Segmented *list, size_t index);                         \
+    LIST_FN size_t size_##list_name##Segmented(list_name##Segmented *list);                                    \
+    LIST_FN size_t capacity_##list_name##Segmented(list_name##Segmented *list);                                \
+    LIST_FN void for_each_##list_name##Segmented(list_name##Segmented *list, void (*fn)(type));                \
+    LIST_FN list_name##Segmented *to_segmented_##list_name(list_name *list);                                   \
+    LIST_FN list_name *from_segmented_##list_name(list_name##Segmented *segmented);
+
+/*
+ * Segments are allocated in order as the list grows. pop_ keeps one empty
+ * segment past the last element and frees the rest, so alternating
+ * push/pop at a segment boundary does not thrash the allocator.
+ */
+#define SegmentedListDef(type, list_name)                                                                        \
+    LIST_FN List_errno get_errno_##list_name##Segmented(list_name##Segmented *list) {                            \
+        if (list == NULL) {                                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                                      \
+            return LIST_NOT_EXIST;                                                                               \
+        }                                                                                                        \
+        List_errno err = list->err;                                                                              \
+        list->err = LIST_OK;                                                                                     \
+        set_list_errno(LIST_OK);                                                                                 \
+        return err;                                                                                              \
+    }                                                                                                            \
+                                                                                                                 \
+    static void list_name##Segmented_set_errno(list_name##Segmented *list, List_errno e) {                       \
+        list_store_errno(&list->err, e);                                                                         \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN list_name##Segmented *create_##list_name##Segmented(void) {                                          \
+        list_name##Segmented *list = malloc(sizeof(list_name##Segmented));                                       \
+        if (list == NULL) {                                                                                      \
+            set_list_errno(LIST_ALLOCATION_FAILED);                                                              \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        memset(list->segments, 0, sizeof(list->segments));                                                       \
+        list->count = 0;                                                                                         \
+        list->allocated = 0;                                                                                     \
+        list->err = LIST_OK;                                                                                     \
+        set_list_errno(LIST_OK);                                                                                 \
+        return list;                                                                                             \
+    }                                                                                                            \
+                                                                                                                 \
+    static void list_name##Segmented_trim(list_name##Segmented *list, size_t keep) {                             \
+        while (list->allocated > keep) {                                                                         \
+            list->allocated--;                                                                                   \
+            FREE_ARRAY(type, list->segments[list->allocated], list_segment_size(list->allocated));               \
+            list->segments[list->allocated] = NULL;                                                              \
+        }                                                                                                        \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN void clear_##list_name##Segmented(list_name##Segmented *list) {                                      \
+        if (list == NULL) {                                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                                      \
+            return;                                                                                              \
+        }                                                                                                        \
+        list_name##Segmented_trim(list, 0);                                                                      \
+        list->count = 0;                                                                                         \
+        list_name##Segmented_set_errno(list, LIST_OK);                                                           \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN void destroy_##list_name##Segmented(list_name##Segmented *list) {                                    \
+        if (list == NULL) {                                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                                      \
+            return;                                                                                              \
+        }                                                                                                        \
+        list_name##Segmented_trim(list, 0);                                                                      \
+        free(list);                                                                                              \
+        set_list_errno(LIST_OK);                                                                                 \
+    }                                                                                                            \
+                                                                                                                 \
+    /* Makes sure the segments holding the first `count` elements exist. */                                      \
+    static bool list_name##Segmented_reserve(list_name##Segmented *list, size_t count) {                         \
+        if (count > list_segment_max_capacity(sizeof(type))) {                                                   \
+            list_name##Segmented_set_errno(list, LIST_INVALID_CAPACITY);                                         \
+            return false;                                                                                        \
+        }                                                                                                        \
+        while (list_segment_start(list->allocated) < count) {                                                    \
+            type *segment = CHANGE_ARRAY(type, NULL, 0, list_segment_size(list->allocated));                     \
+            if (segment == NULL) {                                                                               \
+                list_name##Segmented_set_errno(list, LIST_ALLOCATION_FAILED);                                    \
+                return false;                                                                                    \
+            }                                                                                                    \
+            list->segments[list->allocated++] = segment;                                                         \
+        }                                                                                                        \
+        return true;                                                                                             \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN bool push_##list_name##Segmented(list_name##Segmented *list, type Element) {                         \
+        if (list == NULL) {                                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                                      \
+            return false;                                                                                        \
+        }                                                                                                        \
+        if (!list_name##Segmented_reserve(list, list->count + 1)) {                                              \
+            return false;                                                                                        \
+        }                                                                                                        \
+        size_t offset;                                                                                           \
+        size_t segment = list_segment_locate(list->count, &offset);                                              \
+        list->segments[segment][offset] = Element;                                                               \
+        list->count++;                                                                                           \
+        list_name##Segmented_set_errno(list, LIST_OK);                                                           \
+        return true;                                                                                             \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN type pop_##list_name##Segmented(list_name##Segmented *list) {                                        \
+        if (list == NULL) {                                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                                      \
+            return list_name##_default_element;                                                                  \
+        }                                                                                                        \
+        if (list->count == 0) {                                                                                  \
+            list_name##Segmented_set_errno(list, LIST_EMPTY);                                                    \
+            return list_name##_default_element;                                                                  \
+        }                                                                                                        \
+        list->count--;                                                                                           \
+        size_t offset;                                                                                           \
+        size_t segment = list_segment_locate(list->count, &offset);                                              \
+        type Element = list->segments[segment][offset];                                                          \
+        list_name##Segmented_trim(list, list->count == 0 ? 1 : segment + 2);                                     \
+        list_name##Segmented_set_errno(list, LIST_OK);                                                           \
+        return Element;                                                                                          \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN bool append_array_##list_name##Segmented(list_name##Segmented *list, type const *arr, size_t len) {  \
+        if (list == NULL) {                                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                                      \
+            return false;                                                                                        \
+        }                                                                                                        \
+        if (arr == NULL && len > 0) {                                                                            \
+            list_name##Segmented_set_errno(list, LIST_INVALID_RAW_ARRAY);                                        \
+            return false;                                                                                        \
+        }                                                                                                        \
+        if (len > list_segment_max_capacity(sizeof(type)) - list->count) {                                       \
+            list_name##Segmented_set_errno(list, LIST_INVALID_CAPACITY);                                         \
+            return false;                                                                                        \
+        }                                                                                                        \
+        if (!list_name##Segmented_reserve(list, list->count + len)) {                                            \
+            return false;                                                                                        \
+        }                                                                                                        \
+        size_t offset;                                                                                           \
+        size_t segment = list_segment_locate(list->count, &offset);                                              \
+        list->count += len;                                                                                      \
+        while (len > 0) {                                                                                        \
+            size_t n = list_segment_size(segment) - offset;                                                      \
+            if (n > len) {                                                                                       \
+                n = len;                                                                                         \
+            }                                                                                                    \
+            memcpy(list->segments[segment] + offset, arr, n * sizeof(type));                                     \
+            arr += n;                                                                                            \
+            len -= n;                                                                                            \
+            segment++;                                                                                           \
+            offset = 0;                                                                                          \
+        }                                                                                                        \
+        list_name##Segmented_set_errno(list, LIST_OK);                                                           \
+        return true;                                                                                             \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN type *at_##list_name##Segmented(list_name##Segmented *list, size_t index) {                          \
+        if (list == NULL) {                                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                                      \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        if (index >= list->count) {                                                                              \
+            list_name##Segmented_set_errno(list, LIST_OUT_OF_RANGE);                                             \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        size_t offset;                                                                                           \
+        size_t segment = list_segment_locate(index, &offset);                                                    \
+        list_name##Segmented_set_errno(list, LIST_OK);                                                           \
+        return list->segments[segment] + offset;                                                                 \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN type get_##list_name##Segmented(list_name##Segmented *list, size_t index) {                          \
+        type *slot = at_##list_name##Segmented(list, index);                                                     \
+        return slot == NULL ? list_name##_default_element : *slot;                                               \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN bool set_##list_name##Segmented(list_name##Segmented *list, size_t index, type Element) {            \
+        type *slot = at_##list_name##Segmented(list, index);                                                     \
+        if (slot == NULL) {                                                                                      \
+            return false;                                                                                        \
+        }                                                                                                        \
+        *slot = Element;                                                                                         \
+        return true;                                                                                             \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN size_t size_##list_name##Segmented(list_name##Segmented *list) {                                     \
+        if (list == NULL) {                                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                                      \
+            return 0;                                                                                            \
+        }                                                                                                        \
+        return list->count;                                                                                      \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN size_t capacity_##list_name##Segmented(list_name##Segmented *list) {                                 \
+        if (list == NULL) {                                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                                      \
+            return 0;                                                                                            \
+        }                                                                                                        \
+        return list_segment_start(list->allocated);                                                              \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN void for_each_##list_name##Segmented(list_name##Segmented *list, void (*fn)(type)) {                 \
+        if (list == NULL) {                                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                                      \
+            return;                                                                                              \
+        }                                                                                                        \
+        if (fn == NULL) {                                                                                        \
+            list_name##Segmented_set_errno(list, LIST_INVALID_PRINTFN);                                          \
+            return;                                                                                              \
+        }                                                                                                        \
+        size_t remaining = list->count;                                                                          \
+        for (size_t segment = 0; remaining > 0; segment++) {                                                     \
+            size_t n = list_segment_size(segment) < remaining ? list_segment_size(segment) : remaining;          \
+            for (size_t i = 0; i < n; i++) {                                                                     \
+                fn(list->segments[segment][i]);                                                                  \
+            }                                                                                                    \
+            remaining -= n;                                                                                      \
+        }                                                                                                        \
+        list_name##Segmented_set_errno(list, LIST_OK);                                                           \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN list_name##Segmented *to_segmented_##list_name(list_name *list) {                                    \
+        if (list == NULL) {                                                                                      \
+            set_list_errno(LIST_NOT_EXIST);                                                                      \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        list_name##Segmented *segmented = create_##list_name##Segmented();                                       \
+        if (segmented == NULL) {                                                                                 \
+            set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                                                 \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        if (!append_array_##list_name##Segmented(segmented, list->data, (size_t)list->count)) {                  \
+            set_errno_##list_name(list, segmented->err);                                                         \
+            destroy_##list_name##Segmented(segmented);                                                           \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        set_errno_##list_name(list, LIST_OK);                                                                    \
+        return segmented;                                                                                        \
+    }                                                                                                            \
+                                                                                                                 \
+    LIST_FN list_name *from_segmented_##list_name(list_name##Segmented *segmented) {                             \
+        if (segmented == NULL) {                                                                                 \
+            set_list_errno(LIST_NOT_EXIST);                                                                      \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        if (segmented->count > list_name##_max_capacity()) {                                                     \
+            list_name##Segmented_set_errno(segmented, LIST_INVALID_CAPACITY);                                    \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        list_name *list = create_##list_name();                                                                  \
+        if (list == NULL) {                                                                                      \
+            list_name##Segmented_set_errno(segmented, LIST_ALLOCATION_FAILED);                                   \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        if (!reserve_##list_name(list, segmented->count)) {                                                      \
+            destroy_##list_name(list);                                                                           \
+            list_name##Segmented_set_errno(segmented, LIST_ALLOCATION_FAILED);                                   \
+            return NULL;                                                                                         \
+        }                                                                                                        \
+        size_t remaining = segmented->count;                                                                     \
+        for (size_t segment = 0; remaining > 0; segment++) {                                                     \
+            size_t n = list_segment_size(segment) < remaining ? list_segment_size(segment) : remaining;          \
+            memcpy(list->data + (segmented->count - remaining), segmented->segments[segment], n * sizeof(type)); \
+            remaining -= n;                                                                                      \
+        }                                                                                                        \
+        list->count = (list_name##_size_t)segmented->count;                                                      \
+        list_name##Segmented_set_errno(segmented, LIST_OK);                                                      \
+        return list;                                                                                             \
+    }
+
+
+/*
+ * Struct-of-arrays lists: ListDecSoA(Name, (type1, field1), (type2, field2), ...)
+ * keeps one contiguous array per field, sharing count and capacity, so a
+ * scan over one field touches only that field's memory. Rows go in and out
+ * as Name_row structs; list->field1 is the column itself. Up to 16 fields;
+ * field types must not contain commas.
+ */
+#define LIST_SOA_NARGS_(...) LIST_SOA_NARGS_N_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LIST_SOA_NARGS_N_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, n, ...) n
+#define LIST_SOA_CAT_(a, b) LIST_SOA_CAT2_(a, b)
+#define LIST_SOA_CAT2_(a, b) a##b
+#define LIST_SOA_TYPE_(field_type, field) field_type
+#define LIST_SOA_NAME_(field_type, field) field
+#define LIST_SOA_CALL_(M, field_type, field) M(field_type, field)
+#define LIST_SOA_APPLY_(M, pair) LIST_SOA_CALL_(M, LIST_SOA_TYPE_ pair, LIST_SOA_NAME_ pair)
+#define LIST_SOA_EACH_(M, ...) LIST_SOA_CAT_(LIST_SOA_EACH_, LIST_SOA_NARGS_(__VA_ARGS__))(M, __VA_ARGS__)
+#define LIST_SOA_EACH_1(M, pair) LIST_SOA_APPLY_(M, pair)
+#define LIST_SOA_EACH_2(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_1(M, __VA_ARGS__)
+#define LIST_SOA_EACH_3(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_2(M, __VA_ARGS__)
+#define LIST_SOA_EACH_4(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_3(M, __VA_ARGS__)
+#define LIST_SOA_EACH_5(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_4(M, __VA_ARGS__)
+#define LIST_SOA_EACH_6(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_5(M, __VA_ARGS__)
+#define LIST_SOA_EACH_7(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_6(M, __VA_ARGS__)
+#define LIST_SOA_EACH_8(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_7(M, __VA_ARGS__)
+#define LIST_SOA_EACH_9(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_8(M, __VA_ARGS__)
+#define LIST_SOA_EACH_10(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_9(M, __VA_ARGS__)
+#define LIST_SOA_EACH_11(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_10(M, __VA_ARGS__)
+#define LIST_SOA_EACH_12(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_11(M, __VA_ARGS__)
+#define LIST_SOA_EACH_13(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_12(M, __VA_ARGS__)
+#define LIST_SOA_EACH_14(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_13(M, __VA_ARGS__)
+#define LIST_SOA_EACH_15(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_14(M, __VA_ARGS__)
+#define LIST_SOA_EACH_16(M, pair, ...) LIST_SOA_APPLY_(M, pair) LIST_SOA_EACH_15(M, __VA_ARGS__)
+
+#define LIST_SOA_ROW_FIELD_(field_type, field) field_type field;
+#define LIST_SOA_COLUMN_FIELD_(field_type, field) field_type *field;
+#define LIST_SOA_INIT_(field_type, field) list->field = NULL;
+#define LIST_SOA_FREE_(field_type, field) FREE_ARRAY(field_type, list->field, list->capacity);
+#define LIST_SOA_GROW_(field_type, field)                                                         \
+    if (ok) {                                                                                     \
+        field_type *column = CHANGE_ARRAY(field_type, list->field, list->capacity, new_capacity); \
+        if (column == NULL) {                                                                     \
+            ok = false;                                                                           \
+        } else {                                                                                  \
+            list->field = column;                                                                 \
+        }                                                                                         \
+    }
+#define LIST_SOA_STORE_(field_type, field) list->field[index] = row.field;
+#define LIST_SOA_LOAD_(field_type, field) row.field = list->field[index];
+#define LIST_SOA_SHIFT_UP_(field_type, field) \
+    memmove(list->field + index + 1, list->field + index, (list->count - index) * sizeof(field_type));
+#define LIST_SOA_SHIFT_DOWN_(field_type, field) \
+    memmove(list->field + index, list->field + index + 1, (list->count - index - 1) * sizeof(field_type));
+
+#define ListDecSoA(list_name, ...)                                                             \
+    typedef struct                                                                             \
+    {                                                                                          \
+        LIST_SOA_EACH_(LIST_SOA_ROW_FIELD_, __VA_ARGS__)                                       \
+    } list_name##_row;                                                                         \
+    typedef struct                                                                             \
+    {                                                                                          \
+        size_t capacity;                                                                       \
+        size_t count;                                                                          \
+        LIST_SOA_EACH_(LIST_SOA_COLUMN_FIELD_, __VA_ARGS__)                                    \
+        List_errno err;                                                                        \
+    } list_name;                                                                               \
+    LIST_VAR list_name##_row list_name##_default_element;                                      \
+                                                                                               \
+    LIST_FN List_errno get_errno_##list_name(list_name *list);                                 \
+    LIST_FN void set_errno_##list_name(list_name *list, List_errno e);                         \
+    LIST_FN list_name *create_##list_name(void);                                               \
+    LIST_FN void destroy_##list_name(list_name *list);                                         \
+    LIST_FN void clear_##list_name(list_name *list);                                           \
+    LIST_FN bool reserve_##list_name(list_name *list, size_t capacity);                        \
+    LIST_FN bool push_##list_name(list_name *list, list_name##_row row);                       \
+    LIST_FN list_name##_row pop_##list_name(list_name *list);                                  \
+    LIST_FN list_name##_row get_##list_name(list_name *list, size_t index);                    \
+    LIST_FN bool set_##list_name(list_name *list, size_t index, list_name##_row row);          \
+    LIST_FN bool insert_##list_name(list_name *list, size_t index, list_name##_row row);       \
+    LIST_FN bool remove_at_##list_name(list_name *list, size_t index);                         \
+    LIST_FN size_t size_##list_name(list_name *list);                                          \
+    LIST_FN size_t capacity_##list_name(list_name *list);
+
+/*
+ * Columns grow together by doubling from 8. If one column cannot grow the
+ * push fails with LIST_ALLOCATION_FAILED and the list keeps its old
+ * capacity; columns that did grow keep their larger buffers.
+ */
+#define ListDefSoA(list_name, ...)                                                             \
+    LIST_FN List_errno get_errno_##list_name(list_name *list) {                                \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return LIST_NOT_EXIST;                                                             \
+        }                                                                                      \
+        List_errno err = list->err;                                                            \
+        list->err = LIST_OK;                                                                   \
+        set_list_errno(LIST_OK);                                                               \
+        return err;                                                                            \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN void set_errno_##list_name(list_name *list, List_errno e) {                        \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return;                                                                            \
+        }                                                                                      \
+        list_store_errno(&list->err, e);                                                       \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name *create_##list_name(void) {                                              \
+        list_name *list = malloc(sizeof(list_name));                                           \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_ALLOCATION_FAILED);                                            \
+            return NULL;                                                                       \
+        }                                                                                      \
+        list->capacity = 0;                                                                    \
+        list->count = 0;                                                                       \
+        LIST_SOA_EACH_(LIST_SOA_INIT_, __VA_ARGS__)                                            \
+        list->err = LIST_OK;                                                                   \
+        set_list_errno(LIST_OK);                                                               \
+        return list;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN void clear_##list_name(list_name *list) {                                          \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return;                                                                            \
+        }                                                                                      \
+        LIST_SOA_EACH_(LIST_SOA_FREE_, __VA_ARGS__)                                            \
+        LIST_SOA_EACH_(LIST_SOA_INIT_, __VA_ARGS__)                                            \
+        list->capacity = 0;                                                                    \
+        list->count = 0;                                                                       \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN void destroy_##list_name(list_name *list) {                                        \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return;                                                                            \
+        }                                                                                      \
+        clear_##list_name(list);                                                               \
+        free(list);                                                                            \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool reserve_##list_name(list_name *list, size_t capacity) {                       \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        size_t max_capacity = SIZE_MAX / sizeof(list_name##_row);                              \
+        if (capacity > max_capacity) {                                                         \
+            set_errno_##list_name(list, LIST_INVALID_CAPACITY);                                \
+            return false;                                                                      \
+        }                                                                                      \
+        if (capacity > list->capacity) {                                                       \
+            size_t new_capacity = list->capacity;                                              \
+            while (new_capacity < capacity) {                                                  \
+                new_capacity = list_grow_capacity(new_capacity, max_capacity);                 \
+            }                                                                                  \
+            bool ok = true;                                                                    \
+            LIST_SOA_EACH_(LIST_SOA_GROW_, __VA_ARGS__)                                        \
+            if (!ok) {                                                                         \
+                set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                           \
+                return false;                                                                  \
+            }                                                                                  \
+            list->capacity = new_capacity;                                                     \
+        }                                                                                      \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool push_##list_name(list_name *list, list_name##_row row) {                      \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (list->count == list->capacity && !reserve_##list_name(list, list->count + 1)) {    \
+            return false;                                                                      \
+        }                                                                                      \
+        size_t index = list->count;                                                            \
+        LIST_SOA_EACH_(LIST_SOA_STORE_, __VA_ARGS__)                                           \
+        list->count++;                                                                         \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name##_row pop_##list_name(list_name *list) {                                 \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return list_name##_default_element;                                                \
+        }                                                                                      \
+        if (list->count == 0) {                                                                \
+            set_errno_##list_name(list, LIST_EMPTY);                                           \
+            return list_name##_default_element;                                                \
+        }                                                                                      \
+        list_name##_row row;                                                                   \
+        size_t index = --list->count;                                                          \
+        LIST_SOA_EACH_(LIST_SOA_LOAD_, __VA_ARGS__)                                            \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return row;                                                                            \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name##_row get_##list_name(list_name *list, size_t index) {                   \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return list_name##_default_element;                                                \
+        }                                                                                      \
+        if (index >= list->count) {                                                            \
+            set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
+            return list_name##_default_element;                                                \
+        }                                                                                      \
+        list_name##_row row;                                                                   \
+        LIST_SOA_EACH_(LIST_SOA_LOAD_, __VA_ARGS__)                                            \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return row;                                                                            \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool set_##list_name(list_name *list, size_t index, list_name##_row row) {         \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (index >= list->count) {                                                            \
+            set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        LIST_SOA_EACH_(LIST_SOA_STORE_, __VA_ARGS__)                                           \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool insert_##list_name(list_name *list, size_t index, list_name##_row row) {      \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (index > list->count) {                                                             \
+            set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (list->count == list->capacity && !reserve_##list_name(list, list->count + 1)) {    \
+            return false;                                                                      \
+        }                                                                                      \
+        LIST_SOA_EACH_(LIST_SOA_SHIFT_UP_, __VA_ARGS__)                                        \
+        LIST_SOA_EACH_(LIST_SOA_STORE_, __VA_ARGS__)                                           \
+        list->count++;                                                                         \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool remove_at_##list_name(list_name *list, size_t index) {                        \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (index >= list->count) {                                                            \
+            set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        LIST_SOA_EACH_(LIST_SOA_SHIFT_DOWN_, __VA_ARGS__)                                      \
+        list->count--;                                                                         \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN size_t size_##list_name(list_name *list) {                                         \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return 0;                                                                          \
+        }                                                                                      \
+        return list->count;                                                                    \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN size_t capacity_##list_name(list_name *list) {                                     \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return 0;                                                                          \
+        }                                                                                      \
+        return list->capacity;                                                                 \
+    }
+
+
+/* Word helpers for the bit lists; the builtins compile to single instructions where available. */
+static inline size_t list_popcount64(uint64_t word) {
+#if defined(__GNUC__)
+    return (size_t)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555u);
+    word = (word & 0x3333333333333333u) + ((word >> 2) & 0x3333333333333333u);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fu;
+    return (size_t)((word * 0x0101010101010101u) >> 56);
+#endif
+}
+
+/* Index of the lowest set bit; word must not be 0. */
+static inline size_t list_ctz64(uint64_t word) {
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctzll(word);
+#else
+    return list_popcount64((word & (0 - word)) - 1);
+#endif
+}
+
+#define LIST_BIT_WORD(index) ((index) / 64)
+#define LIST_BIT_MASK(index) ((uint64_t)1 << ((index) % 64))
+
+/*
+ * Bit-packed boolean list: 64 flags per uint64_t word. Sizes are size_t and
+ * indices ptrdiff_t, as for ListDec64. Bits past count in the last word are
+ * kept zero, so count_, find_ and the bulk operations work a word at a time.
+ */
+#define BitListDec(list_name)                                                                  \
+    typedef struct                                                                             \
+    {                                                                                          \
+        size_t capacity;                                                                       \
+        size_t count;                                                                          \
+        uint64_t *words;                                                                       \
+        List_errno err;                                                                        \
+    } list_name;                                                                               \
+                                                                                               \
+    LIST_FN List_errno get_errno_##list_name(list_name *list);                                 \
+    LIST_FN void set_errno_##list_name(list_name *list, List_errno e);                         \
+    LIST_FN list_name *create_##list_name(void);                                               \
+    LIST_FN void destroy_##list_name(list_name *list);                                         \
+    LIST_FN void clear_##list_name(list_name *list);                                           \
+    LIST_FN bool reserve_##list_name(list_name *list, size_t capacity);                        \
+    LIST_FN bool push_##list_name(list_name *list, bool value);                                \
+    LIST_FN bool push_n_##list_name(list_name *list, bool value, size_t n);                    \
+    LIST_FN bool pop_##list_name(list_name *list);                                             \
+    LIST_FN bool get_##list_name(list_name *list, size_t index);                               \
+    LIST_FN bool set_##list_name(list_name *list, size_t index, bool value);                   \
+    LIST_FN size_t size_##list_name(list_name *list);                                          \
+    LIST_FN size_t capacity_##list_name(list_name *list);                                      \
+    LIST_FN bool empty_##list_name(list_name *list);                                           \
+    LIST_FN size_t count_##list_name(list_name *list, bool value);                             \
+    LIST_FN ptrdiff_t find_##list_name(list_name *list, bool value);                           \
+    LIST_FN ptrdiff_t find_first_set_##list_name(list_name *list);                             \
+    LIST_FN ptrdiff_t find_next_set_##list_name(list_name *list, size_t start);                \
+    LIST_FN bool and_##list_name(list_name *list_a, list_name *list_b);                        \
+    LIST_FN bool or_##list_name(list_name *list_a, list_name *list_b);                         \
+    LIST_FN bool xor_##list_name(list_name *list_a, list_name *list_b);                        \
+    LIST_FN void print_##list_name(list_name *list);
+
+#define BitListDef(list_name)                                                                  \
+    LIST_FN List_errno get_errno_##list_name(list_name *list) {                                \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return LIST_NOT_EXIST;                                                             \
+        }                                                                                      \
+        List_errno err = list->err;                                                            \
+        list->err = LIST_OK;                                                                   \
+        set_list_errno(LIST_OK);                                                               \
+        return err;                                                                            \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN void set_errno_##list_name(list_name *list, List_errno e) {                        \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return;                                                                            \
+        }                                                                                      \
+        list_store_errno(&list->err, e);                                                       \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN list_name *create_##list_name(void) {                                              \
+        list_name *list = malloc(sizeof(list_name));                                           \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_ALLOCATION_FAILED);                                            \
+            return NULL;                                                                       \
+        }                                                                                      \
+        list->capacity = 0;                                                                    \
+        list->count = 0;                                                                       \
+        list->words = NULL;                                                                    \
+        list->err = LIST_OK;                                                                   \
+        set_list_errno(LIST_OK);                                                               \
+        return list;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN void clear_##list_name(list_name *list) {                                          \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return;                                                                            \
+        }                                                                                      \
+        FREE_ARRAY(uint64_t, list->words, list->capacity / 64);                                \
+        list->words = NULL;                                                                    \
+        list->capacity = 0;                                                                    \
+        list->count = 0;                                                                       \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN void destroy_##list_name(list_name *list) {                                        \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return;                                                                            \
+        }                                                                                      \
+        clear_##list_name(list);                                                               \
+        free(list);                                                                            \
+    }                                                                                          \
+                                                                                               \
+    /* capacity is in bits; the word array doubles from 8 words (512 bits). */                 \
+    LIST_FN bool reserve_##list_name(list_name *list, size_t capacity) {                       \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        size_t max_words = (size_t)PTRDIFF_MAX / 64;                                           \
+        if (capacity > max_words * 64) {                                                       \
+            set_errno_##list_name(list, LIST_INVALID_CAPACITY);                                \
+            return false;                                                                      \
+        }                                                                                      \
+        size_t old_words = list->capacity / 64;                                                \
+        size_t need_words = (capacity + 63) / 64;                                              \
+        if (need_words > old_words) {                                                          \
+            size_t new_words = old_words;                                                      \
+            while (new_words < need_words) {                                                   \
+                new_words = list_grow_capacity(new_words, max_words);                          \
+            }                                                                                  \
+            uint64_t *words = CHANGE_ARRAY(uint64_t, list->words, old_words, new_words);       \
+            if (words == NULL) {                                                               \
+                set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                           \
+                return false;                                                                  \
+            }                                                                                  \
+            memset(words + old_words, 0, (new_words - old_words) * sizeof(uint64_t));          \
+            list->words = words;                                                               \
+            list->capacity = new_words * 64;                                                   \
+        }                                                                                      \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool push_##list_name(list_name *list, bool value) {                               \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (list->count == list->capacity && !reserve_##list_name(list, list->count + 1)) {    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (value) {                                                                           \
+            list->words[LIST_BIT_WORD(list->count)] |= LIST_BIT_MASK(list->count);             \
+        }                                                                                      \
+        list->count++;                                                                         \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    /* Appends n copies of value, filling whole words at once. */                              \
+    LIST_FN bool push_n_##list_name(list_name *list, bool value, size_t n) {                   \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (n > SIZE_MAX - list->count) {                                                      \
+            set_errno_##list_name(list, LIST_INVALID_CAPACITY);                                \
+            return false;                                                                      \
+        }                                                                                      \
+        if (!reserve_##list_name(list, list->count + n)) {                                     \
+            return false;                                                                      \
+        }                                                                                      \
+        size_t end = list->count + n;                                                          \
+        if (value) {                                                                           \
+            size_t i = list->count;                                                            \
+            for (; i < end && i % 64 != 0; i++) {                                              \
+                list->words[LIST_BIT_WORD(i)] |= LIST_BIT_MASK(i);                             \
+            }                                                                                  \
+            for (; i + 64 <= end; i += 64) {                                                   \
+                list->words[LIST_BIT_WORD(i)] = UINT64_MAX;                                    \
+            }                                                                                  \
+            for (; i < end; i++) {                                                             \
+                list->words[LIST_BIT_WORD(i)] |= LIST_BIT_MASK(i);                             \
+            }                                                                                  \
+        }                                                                                      \
+        list->count = end;                                                                     \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool pop_##list_name(list_name *list) {                                            \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (list->count == 0) {                                                                \
+            set_errno_##list_name(list, LIST_EMPTY);                                           \
+            return false;                                                                      \
+        }                                                                                      \
+        list->count--;                                                                         \
+        uint64_t *word = &list->words[LIST_BIT_WORD(list->count)];                             \
+        bool value = (*word & LIST_BIT_MASK(list->count)) != 0;                                \
+        *word &= ~LIST_BIT_MASK(list->count);                                                  \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return value;                                                                          \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool get_##list_name(list_name *list, size_t index) {                              \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (index >= list->count) {                                                            \
+            set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return (list->words[LIST_BIT_WORD(index)] & LIST_BIT_MASK(index)) != 0;                \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool set_##list_name(list_name *list, size_t index, bool value) {                  \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (index >= list->count) {                                                            \
+            set_errno_##list_name(list, LIST_OUT_OF_RANGE);                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (value) {                                                                           \
+            list->words[LIST_BIT_WORD(index)] |= LIST_BIT_MASK(index);                         \
+        } else {                                                                               \
+            list->words[LIST_BIT_WORD(index)] &= ~LIST_BIT_MASK(index);                        \
+        }                                                                                      \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN size_t size_##list_name(list_name *list) {                                         \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return 0;                                                                          \
+        }                                                                                      \
+        return list->count;                                                                    \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN size_t capacity_##list_name(list_name *list) {                                     \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return 0;                                                                          \
+        }                                                                                      \
+        return list->capacity;                                                                 \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool empty_##list_name(list_name *list) {                                          \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return true;                                                                       \
+        }                                                                                      \
+        return list->count == 0;                                                               \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN size_t count_##list_name(list_name *list, bool value) {                            \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return 0;                                                                          \
+        }                                                                                      \
+        size_t ones = 0;                                                                       \
+        for (size_t w = 0; w < (list->count + 63) / 64; w++) {                                 \
+            ones += list_popcount64(list->words[w]);                                           \
+        }                                                                                      \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        return value ? ones : list->count - ones;                                              \
+    }                                                                                          \
+                                                                                               \
+    /* Index of the first bit equal to value at or after start, or -1. */                      \
+    static ptrdiff_t list_name##_find_from(list_name *list, bool value, size_t start) {        \
+        if (list == NULL) {                                                                    \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return -1;                                                                         \
+        }                                                                                      \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+        if (start >= list->count) {                                                            \
+            return -1;                                                                         \
+        }                                                                                      \
+        uint64_t flip = value ? 0 : UINT64_MAX;                                                \
+        size_t w = LIST_BIT_WORD(start);                                                       \
+        uint64_t word = (list->words[w] ^ flip) & (UINT64_MAX << (start % 64));                \
+        size_t words = (list->count + 63) / 64;                                                \
+        while (word == 0) {                                                                    \
+            if (++w >= words) {                                                                \
+                return -1;                                                                     \
+            }                                                                                  \
+            word = list->words[w] ^ flip;                                                      \
+        }                                                                                      \
+        size_t index = w * 64 + list_ctz64(word);                                              \
+        return index < list->count ? (ptrdiff_t)index : -1;                                    \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN ptrdiff_t find_##list_name(list_name *list, bool value) {                          \
+        return list_name##_find_from(list, value, 0);                                          \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN ptrdiff_t find_first_set_##list_name(list_name *list) {                            \
+        return list_name##_find_from(list, true, 0);                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN ptrdiff_t find_next_set_##list_name(list_name *list, size_t start) {               \
+        return list_name##_find_from(list, true, start);                                       \
+    }                                                                                          \
+                                                                                               \
+    /* list_a op= list_b word by word; both lists must hold the same number of bits. */        \
+    static bool list_name##_combine(list_name *list_a, list_name *list_b, int op) {            \
+        if (list_a == NULL || list_b == NULL) {                                                \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return false;                                                                      \
+        }                                                                                      \
+        if (list_a->count != list_b->count) {                                                  \
+            set_errno_##list_name(list_a, LIST_OUT_OF_RANGE);                                  \
+            return false;                                                                      \
+        }                                                                                      \
+        uint64_t *a = list_a->words;                                                           \
+        const uint64_t *b = list_b->words;                                                     \
+        size_t words = (list_a->count + 63) / 64;                                              \
+        switch (op) {                                                                          \
+        case '&':                                                                              \
+            for (size_t w = 0; w < words; w++) {                                               \
+                a[w] &= b[w];                                                                  \
+            }                                                                                  \
+            break;                                                                             \
+        case '|':                                                                              \
+            for (size_t w = 0; w < words; w++) {                                               \
+                a[w] |= b[w];                                                                  \
+            }                                                                                  \
+            break;                                                                             \
+        default:                                                                               \
+            for (size_t w = 0; w < words; w++) {                                               \
+                a[w] ^= b[w];                                                                  \
+            }                                                                                  \
+            break;                                                                             \
+        }                                                                                      \
+        set_errno_##list_name(list_a, LIST_OK);                                                \
+        return true;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool and_##list_name(list_name *list_a, list_name *list_b) {                       \
+        return list_name##_combine(list_a, list_b, '&');                                       \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool or_##list_name(list_name *list_a, list_name *list_b) {                        \
+        return list_name##_combine(list_a, list_b, '|');                                       \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN bool xor_##list_name(list_name *list_a, list_name *list_b) {                       \
+        return list_name##_combine(list_a, list_b, '^');                                       \
+    }                                                                                          \
+                                                                                               \
+    LIST_FN void print_##list_name(list_name *list) {                                          \
+        if (list == NULL) {                                                                    \
+            printf("NULL\n");                                                                  \
+            set_list_errno(LIST_NOT_EXIST);                                                    \
+            return;                                                                            \
+        }                                                                                      \
+        printf("[");                                                                           \
+        for (size_t i = 0; i < list->count; i++) {                                             \
+            printf(i + 1 < list->count ? "%d," : "%d",                                         \
+                   (list->words[LIST_BIT_WORD(i)] & LIST_BIT_MASK(i)) != 0);                   \
+        }                                                                                      \
+        printf("]\n");                                                                         \
+        set_errno_##list_name(list, LIST_OK);                                                  \
+    }
+
+
+/*
+ * Packed integer lists: values are appended into a 128-element tail and each
+ * full tail is encoded as one block of 2 * width uint64_t words, where width
+ * is the bit width of the largest stored offset. A block stores either every
+ * value minus the block minimum (frame of reference) or, for non-decreasing
+ * runs where it is narrower, the difference to the previous value (delta).
+ */
+#define LIST_PACKED_BLOCK 128
+
+typedef struct {
+    uint64_t base;
+    size_t offset;
+    unsigned char width;
+    unsigned char delta;
+} List_packed_block;
+
+static inline unsigned list_bit_width(uint64_t value) {
+    unsigned width = 0;
+    while (value != 0) {
+        value >>= 1;
+        width++;
+    }
+    return width;
+}
+
+/* Packs LIST_PACKED_BLOCK values of `width` bits into 2 * width zeroed words. */
+static inline void list_pack_block(const uint64_t *values, unsigned width, uint64_t *words) {
+    if (width == 0) {
+        return;
+    }
+    for (size_t i = 0; i < LIST_PACKED_BLOCK; i++) {
+        size_t bit = i * width;
+        size_t shift = bit % 64;
+        words[bit / 64] |= values[i] << shift;
+        if (shift + width > 64) {
+            words[bit / 64 + 1] |= values[i] >> (64 - shift);
+        }
+    }
+}
+
+static inline uint64_t list_unpack_value(const uint64_t *words, unsigned width, size_t i) {
+    if (width == 0) {
+        return 0;
+    }
+    size_t bit = i * width;
+    size_t shift = bit % 64;
+    uint64_t value = words[bit / 64] >> shift;
+    if (shift + width > 64) {
+        value |= words[bit / 64 + 1] << (64 - shift);
+    }
+    return width == 64 ? value : value & (((uint64_t)1 << width) - 1);
+}
+
+/* Decodes a whole block to absolute values. */
+static inline void list_unpack_block(const List_packed_block *block, const uint64_t *words, uint64_t *values) {
+    const uint64_t *packed = words + block->offset;
+    uint64_t running = block->base;
+    for (size_t i = 0; i < LIST_PACKED_BLOCK; i++) {
+        uint64_t stored = list_unpack_value(packed, block->width, i);
+        if (block->delta) {
+            running += stored;
+            values[i] = running;
+        } else {
+            values[i] = block->base + stored;
+        }
+    }
+}
+
+/*
+ * Packed companion of a ListDec'd list of an unsigned integer type. It is
+ * append-only: push_ and append_array_ add values, get_ decodes one value
+ * (one block for delta blocks), and decode_block_ / for_each_ stream whole
+ * blocks for scans. lower_bound_ assumes the values are non-decreasing.
+ */
+#define PackedListDec(type, list_name)                                                                   \
+    _Static_assert((type)-1 > (type)0 && sizeof(type) <= sizeof(uint64_t),                               \
+                   "PackedListDec needs an unsigned integer type of at most 64 bits");                   \
+    typedef struct {                                                                                     \
+        List_packed_block *blocks;                                                                       \
+        size_t block_count;                                                                              \
+        size_t block_capacity;                                                                           \
+        uint64_t *words;                                                                                 \
+        size_t word_count;                                                                               \
+        size_t word_capacity;                                                                            \
+        type tail[LIST_PACKED_BLOCK];                                                                    \
+        size_t count;                                                                                    \
+        List_errno err;                                                                                  \
+    } list_name##Packed;                                                                                 \
+                                                                                                         \
+    LIST_FN List_errno get_errno_##list_name##Packed(list_name##Packed *list);                           \
+    LIST_FN list_name##Packed *create_##list_name##Packed(void);                                         \
+    LIST_FN void destroy_##list_name##Packed(list_name##Packed *list);                                   \
+    LIST_FN void clear_##list_name##Packed(list_name##Packed *list);                                     \
+    LIST_FN bool push_##list_name##Packed(list_name##Packed *list, type Element);                        \
+    LIST_FN bool append_array_##list_name##Packed(list_name##Packed *list, type const *arr, size_t len); \
+    LIST_FN type get_##list_name##Packed(list_name##Packed *list, size_t index);                         \
+    LIST_FN size_t lower_bound_##list_name##Packed(list_name##Packed *list, type Element);               \
+    LIST_FN size_t decode_block_##list_name##Packed(list_name##Packed *list, size_t block, type *out);   \
+    LIST_FN void for_each_##list_name##Packed(list_name##Packed *list, void (*fn)(type));                \
+    LIST_FN size_t size_##list_name##Packed(list_name##Packed *list);                                    \
+    LIST_FN size_t bytes_##list_name##Packed(list_name##Packed *list);                                   \
+    LIST_FN list_name##Packed *to_packed_##list_name(list_name *list);                                   \
+    LIST_FN list_name *from_packed_##list_name(list_name##Packed *packed);
+
+#define PackedListDef(type, list_name)                                                                                \
+    LIST_FN List_errno get_errno_##list_name##Packed(list_name##Packed *list) {                                       \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return LIST_NOT_EXIST;                                                                                    \
+        }                                                                                                             \
+        List_errno err = list->err;                                                                                   \
+        list->err = LIST_OK;                                                                                          \
+        set_list_errno(LIST_OK);                                                                                      \
+        return err;                                                                                                   \
+    }                                                                                                                 \
+                                                                                                                      \
+    static void list_name##Packed_set_errno(list_name##Packed *list, List_errno e) {                                  \
+        list_store_errno(&list->err, e);                                                                              \
+    }                                                                                                                 \
+                                                                                                                      \
+    LIST_FN list_name##Packed *create_##list_name##Packed(void) {                                                     \
+        list_name##Packed *list = malloc(sizeof(list_name##Packed));                                                  \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_ALLOCATION_FAILED);                                                                   \
+            return NULL;                                                                                              \
+        }                                                                                                             \
+        list->blocks = NULL;                                                                                          \
+        list->block_count = 0;                                                                                        \
+        list->block_capacity = 0;                                                                                     \
+        list->words = NULL;                                                                                           \
+        list->word_count = 0;                                                                                         \
+        list->word_capacity = 0;                                                                                      \
+        list->count = 0;                                                                                              \
+        list->err = LIST_OK;                                                                                          \
+        set_list_errno(LIST_OK);                                                                                      \
+        return list;                                                                                                  \
+    }                                                                                                                 \
+                                                                                                                      \
+    LIST_FN void clear_##list_name##Packed(list_name##Packed *list) {                                                 \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return;                                                                                                   \
+        }                                                                                                             \
+        FREE_ARRAY(List_packed_block, list->blocks, list->block_capacity);                                            \
+        FREE_ARRAY(uint64_t, list->words, list->word_capacity);                                                       \
+        list->blocks = NULL;                                                                                          \
+        list->block_count = 0;                                                                                        \
+        list->block_capacity = 0;                                                                                     \
+        list->words = NULL;                                                                                           \
+        list->word_count = 0;                                                                                         \
+        list->word_capacity = 0;                                                                                      \
+        list->count = 0;                                                                                              \
+        list_name##Packed_set_errno(list, LIST_OK);                                                                   \
+    }                                                                                                                 \
+                                                                                                                      \
+    LIST_FN void destroy_##list_name##Packed(list_name##Packed *list) {                                               \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return;                                                                                                   \
+        }                                                                                                             \
+        clear_##list_name##Packed(list);                                                                              \
+        free(list);                                                                                                   \
+        set_list_errno(LIST_OK);                                                                                      \
+    }                                                                                                                 \
+                                                                                                                      \
+    /* Encodes the full tail as a new block, using whichever encoding is narrower. */                                 \
+    static bool list_name##Packed_flush(list_name##Packed *list) {                                                    \
+        uint64_t values[LIST_PACKED_BLOCK];                                                                           \
+        uint64_t min = (uint64_t)list->tail[0], max = min, max_delta = 0;                                             \
+        bool ascending = true;                                                                                        \
+        for (size_t i = 0; i < LIST_PACKED_BLOCK; i++) {                                                              \
+            values[i] = (uint64_t)list->tail[i];                                                                      \
+            min = values[i] < min ? values[i] : min;                                                                  \
+            max = values[i] > max ? values[i] : max;                                                                  \
+            if (i > 0) {                                                                                              \
+                ascending = ascending && values[i] >= values[i - 1];                                                  \
+                uint64_t delta = values[i] - values[i - 1];                                                           \
+                max_delta = delta > max_delta ? delta : max_delta;                                                    \
+            }                                                                                                         \
+        }                                                                                                             \
+        List_packed_block block = {min, list->word_count, (unsigned char)list_bit_width(max - min), 0};               \
+        if (ascending && list_bit_width(max_delta) < block.width) {                                                   \
+            block.width = (unsigned char)list_bit_width(max_delta);                                                   \
+            block.delta = 1;                                                                                          \
+            for (size_t i = LIST_PACKED_BLOCK - 1; i > 0; i--) {                                                      \
+                values[i] -= values[i - 1];                                                                           \
+            }                                                                                                         \
+            values[0] = 0;                                                                                            \
+        } else {                                                                                                      \
+            for (size_t i = 0; i < LIST_PACKED_BLOCK; i++) {                                                          \
+                values[i] -= min;                                                                                     \
+            }                                                                                                         \
+        }                                                                                                             \
+        size_t words = 2 * (size_t)block.width;                                                                       \
+        if (list->word_count + words > list->word_capacity) {                                                         \
+            size_t capacity = list->word_capacity;                                                                    \
+            while (capacity < list->word_count + words) {                                                             \
+                capacity = list_grow_capacity(capacity, SIZE_MAX / sizeof(uint64_t));                                 \
+                if (capacity == 0) {                                                                                  \
+                    list_name##Packed_set_errno(list, LIST_INVALID_CAPACITY);                                         \
+                    return false;                                                                                     \
+                }                                                                                                     \
+            }                                                                                                         \
+            uint64_t *grown = CHANGE_ARRAY(uint64_t, list->words, list->word_capacity, capacity);                     \
+            if (grown == NULL) {                                                                                      \
+                list_name##Packed_set_errno(list, LIST_ALLOCATION_FAILED);                                            \
+                return false;                                                                                         \
+            }                                                                                                         \
+            list->words = grown;                                                                                      \
+            list->word_capacity = capacity;                                                                           \
+        }                                                                                                             \
+        if (list->block_count == list->block_capacity) {                                                              \
+            size_t capacity = list_grow_capacity(list->block_capacity, SIZE_MAX / sizeof(List_packed_block));         \
+            if (capacity == 0) {                                                                                      \
+                list_name##Packed_set_errno(list, LIST_INVALID_CAPACITY);                                             \
+                return false;                                                                                         \
+            }                                                                                                         \
+            List_packed_block *grown = CHANGE_ARRAY(List_packed_block, list->blocks, list->block_capacity, capacity); \
+            if (grown == NULL) {                                                                                      \
+                list_name##Packed_set_errno(list, LIST_ALLOCATION_FAILED);                                            \
+                return false;                                                                                         \
+            }                                                                                                         \
+            list->blocks = grown;                                                                                     \
+            list->block_capacity = capacity;                                                                          \
+        }                                                                                                             \
+        memset(list->words + list->word_count, 0, words * sizeof(uint64_t));                                          \
+        list_pack_block(values, block.width, list->words + list->word_count);                                         \
+        list->word_count += words;                                                                                    \
+        list->blocks[list->block_count++] = block;                                                                    \
+        return true;                                                                                                  \
+    }                                                                                                                 \
+                                                                                                                      \
+    LIST_FN bool push_##list_name##Packed(list_name##Packed *list, type Element) {                                    \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return false;                                                                                             \
+        }                                                                                                             \
+        list->tail[list->count % LIST_PACKED_BLOCK] = Element;                                                        \
+        if (list->count % LIST_PACKED_BLOCK == LIST_PACKED_BLOCK - 1 && !list_name##Packed_flush(list)) {             \
+            return false;                                                                                             \
+        }                                                                                                             \
+        list->count++;                                                                                                \
+        list_name##Packed_set_errno(list, LIST_OK);                                                                   \
+        return true;                                                                                                  \
+    }                                                                                                                 \
+                                                                                                                      \
+    LIST_FN bool append_array_##list_name##Packed(list_name##Packed *list, type const *arr, size_t len) {             \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return false;                                                                                             \
+        }                                                                                                             \
+        if (arr == NULL && len > 0) {                                                                                 \
+            list_name##Packed_set_errno(list, LIST_INVALID_RAW_ARRAY);                                                \
+            return false;                                                                                             \
+        }                                                                                                             \
+        for (size_t i = 0; i < len; i++) {                                                                            \
+            if (!push_##list_name##Packed(list, arr[i])) {                                                            \
+                return false;                                                                                         \
+            }                                                                                                         \
+        }                                                                                                             \
+        list_name##Packed_set_errno(list, LIST_OK);                                                                   \
+        return true;                                                                                                  \
+    }                                                                                                                 \
+                                                                                                                      \
+    LIST_FN type get_##list_name##Packed(list_name##Packed *list, size_t index) {                                     \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return list_name##_default_element;                                                                       \
+        }                                                                                                             \
+        if (index >= list->count) {                                                                                   \
+            list_name##Packed_set_errno(list, LIST_OUT_OF_RANGE);                                                     \
+            return list_name##_default_element;                                                                       \
+        }                                                                                                             \
+        list_name##Packed_set_errno(list, LIST_OK);                                                                   \
+        size_t b = index / LIST_PACKED_BLOCK, i = index % LIST_PACKED_BLOCK;                                          \
+        if (b == list->block_count) {                                                                                 \
+            return list->tail[i];                                                                                     \
+        }                                                                                                             \
+        const List_packed_block *block = &list->blocks[b];                                                            \
+        const uint64_t *packed = list->words + block->offset;                                                         \
+        if (!block->delta) {                                                                                          \
+            return (type)(block->base + list_unpack_value(packed, block->width, i));                                  \
+        }                                                                                                             \
+        uint64_t value = block->base;                                                                                 \
+        for (size_t j = 1; j <= i; j++) {                                                                             \
+            value += list_unpack_value(packed, block->width, j);                                                      \
+        }                                                                                                             \
+        return (type)value;                                                                                           \
+    }                                                                                                                 \
+                                                                                                                      \
+    /* Writes block `block` (the tail being the last one) to out; returns how many values it holds. */                \
+    LIST_FN size_t decode_block_##list_name##Packed(list_name##Packed *list, size_t block, type *out) {               \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return 0;                                                                                                 \
+        }                                                                                                             \
+        if (block > list->block_count || out == NULL) {                                                               \
+            list_name##Packed_set_errno(list, out == NULL ? LIST_INVALID_RAW_ARRAY : LIST_OUT_OF_RANGE);              \
+            return 0;                                                                                                 \
+        }                                                                                                             \
+        list_name##Packed_set_errno(list, LIST_OK);                                                                   \
+        if (block == list->block_count) {                                                                             \
+            size_t n = list->count % LIST_PACKED_BLOCK;                                                               \
+            memcpy(out, list->tail, n * sizeof(type));                                                                \
+            return n;                                                                                                 \
+        }                                                                                                             \
+        uint64_t values[LIST_PACKED_BLOCK];                                                                           \
+        list_unpack_block(&list->blocks[block], list->words, values);                                                 \
+        for (size_t i = 0; i < LIST_PACKED_BLOCK; i++) {                                                              \
+            out[i] = (type)values[i];                                                                                 \
+        }                                                                                                             \
+        return LIST_PACKED_BLOCK;                                                                                     \
+    }                                                                                                                 \
+                                                                                                                      \
+    /* Skips whole blocks by their first value, then searches inside one decoded block. */                            \
+    LIST_FN size_t lower_bound_##list_name##Packed(list_name##Packed *list, type Element) {                           \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return 0;                                                                                                 \
+        }                                                                                                             \
+        list_name##Packed_set_errno(list, LIST_OK);                                                                   \
+        uint64_t target = (uint64_t)Element;                                                                          \
+        size_t low = 0, high = list->block_count;                                                                     \
+        while (low < high) {                                                                                          \
+            size_t mid = low + (high - low) / 2;                                                                      \
+            if (list->blocks[mid].base < target) {                                                                    \
+                low = mid + 1;                                                                                        \
+            } else {                                                                                                  \
+                high = mid;                                                                                           \
+            }                                                                                                         \
+        }                                                                                                             \
+        if (low > 0) {                                                                                                \
+            uint64_t values[LIST_PACKED_BLOCK];                                                                       \
+            list_unpack_block(&list->blocks[low - 1], list->words, values);                                           \
+            for (size_t i = 0; i < LIST_PACKED_BLOCK; i++) {                                                          \
+                if (values[i] >= target) {                                                                            \
+                    return (low - 1) * LIST_PACKED_BLOCK + i;                                                         \
+                }                                                                                                     \
+            }                                                                                                         \
+        }                                                                                                             \
+        if (low < list->block_count) {                                                                                \
+            return low * LIST_PACKED_BLOCK;                                                                           \
+        }                                                                                                             \
+        size_t start = list->block_count * LIST_PACKED_BLOCK;                                                         \
+        for (size_t i = start; i < list->count; i++) {                                                                \
+            if ((uint64_t)list->tail[i - start] >= target) {                                                          \
+                return i;                                                                                             \
+            }                                                                                                         \
+        }                                                                                                             \
+        return list->count;                                                                                           \
+    }                                                                                                                 \
+                                                                                                                      \
+    LIST_FN void for_each_##list_name##Packed(list_name##Packed *list, void (*fn)(type)) {                            \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return;                                                                                                   \
+        }                                                                                                             \
+        if (fn == NULL) {                                                                                             \
+            list_name##Packed_set_errno(list, LIST_INVALID_PRINTFN);                                                  \
+            return;                                                                                                   \
+        }                                                                                                             \
+        type values[LIST_PACKED_BLOCK];                                                                               \
+        for (size_t b = 0; b <= list->block_count; b++) {                                                             \
+            size_t n = decode_block_##list_name##Packed(list, b, values);                                             \
+            for (size_t i = 0; i < n; i++) {                                                                          \
+                fn(values[i]);                                                                                        \
+            }                                                                                                         \
+        }                                                                                                             \
+        list_name##Packed_set_errno(list, LIST_OK);                                                                   \
+    }                                                                                                                 \
+                                                                                                                      \
+    LIST_FN size_t size_##list_name##Packed(list_name##Packed *list) {                                                \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return 0;                                                                                                 \
+        }                                                                                                             \
+        return list->count;                                                                                           \
+    }                                                                                                                 \
+                                                                                                                      \
+    /* Heap and struct bytes in use, for comparing against count * sizeof(type). */                                   \
+    LIST_FN size_t bytes_##list_name##Packed(list_name##Packed *list) {                                               \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return 0;                                                                                                 \
+        }                                                                                                             \
+        return sizeof(list_name##Packed) + list->block_count * sizeof(List_packed_block) +                            \
+               list->word_count * sizeof(uint64_t);                                                                   \
+    }                                                                                                                 \
+                                                                                                                      \
+    LIST_FN list_name##Packed *to_packed_##list_name(list_name *list) {                                               \
+        if (list == NULL) {                                                                                           \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return NULL;                                                                                              \
+        }                                                                                                             \
+        list_name##Packed *packed = create_##list_name##Packed();                                                     \
+        if (packed == NULL) {                                                                                         \
+            set_errno_##list_name(list, LIST_ALLOCATION_FAILED);                                                      \
+            return NULL;                                                                                              \
+        }                                                                                                             \
+        if (!append_array_##list_name##Packed(packed, list->data, (size_t)list->count)) {                             \
+            set_errno_##list_name(list, packed->err);                                                                 \
+            destroy_##list_name##Packed(packed);                                                                      \
+            return NULL;                                                                                              \
+        }                                                                                                             \
+        set_errno_##list_name(list, LIST_OK);                                                                         \
+        return packed;                                                                                                \
+    }                                                                                                                 \
+                                                                                                                      \
+    LIST_FN list_name *from_packed_##list_name(list_name##Packed *packed) {                                           \
+        if (packed == NULL) {                                                                                         \
+            set_list_errno(LIST_NOT_EXIST);                                                                           \
+            return NULL;                                                                                              \
+        }                                                                                                             \
+        if (packed->count > list_name##_max_capacity()) {                                                             \
+            list_name##Packed_set_errno(packed, LIST_INVALID_CAPACITY);                                               \
+            return NULL;                                                                                              \
+        }                                                                                                             \
+        list_name *list = create_##list_name();                                                                       \
+        if (list == NULL) {                                                                                           \
+            list_name##Packed_set_errno(packed, LIST_ALLOCATION_FAILED);                                              \
+            return NULL;                                                                                              \
+        }                                                                                                             \
+        if (!reserve_##list_name(list, packed->count)) {                                                              \
+            destroy_##list_name(list);                                                                                \
+            list_name##Packed_set_errno(packed, LIST_ALLOCATION_FAILED);                                              \
+            return NULL;                                                                                              \
+        }                                                                                                             \
+        for (size_t b = 0; b * LIST_PACKED_BLOCK < packed->count; b++) {                                              \
+            decode_block_##list_name##Packed(packed, b, list->data + b * LIST_PACKED_BLOCK);                          \
+        }                                                                                                             \
+        list->count = (list_name##_size_t)packed->count;                                                              \
+        list_name##Packed_set_errno(packed, LIST_OK);                                                                 \
+        return list;                                                                                                  \
+    }
+
+
 #endif //C_LIST_H
@@ -7,10 +7,137 @@ ListDec(int, IntList)
 
 ListDef(int, IntList)
 
+ListDecOrdered(int, IntList)
+
+ListDefOrderedInt(int, IntList)
+
+ListDecHeap(int, IntList)
+
+ListDefHeap(int, IntList, LIST_LESS)
+
+ListDecParallel(int, IntList)
+
+ListDefParallel(int, IntList)
+
+ListDecParallelSort(int, IntList)
+
+ListDefParallelSort(int, IntList, LIST_LESS)
+
+SegmentedListDec(int, IntList)
+
+SegmentedListDef(int, IntList)
+
+ListIndexDec(int, IntList)
+
+ListIndexDef(int, IntList, LIST_HASH_INT, LIST_EQ)
+
+ListDecFile(int, IntList)
+
+ListDefFile(int, IntList)
+
+ListDec64(double, BigList)
+
+ListDef(double, BigList)
+
+ListDecFile(double, BigList)
+
+ListDefFile(double, BigList)
+
+#define DOUBLE_GREATER(a, b) ((a) > (b))
+
+ListDecOrdered(double, BigList)
+
+ListDefOrdered(double, BigList, DOUBLE_GREATER)
+
+ConcurrentListDec(int, SharedIntList)
+
+ConcurrentListDef(int, SharedIntList)
+
+ListDecSBO(int, SmallIntList, 8)
+
+ListDef(int, SmallIntList)
+
+DequeDec(int, IntDeque)
+
+DequeDef(int, IntDeque)
+
+ListDec(uint32_t, IdList)
+
+ListDef(uint32_t, IdList)
+
+PackedListDec(uint32_t, IdList)
+
+PackedListDef(uint32_t, IdList)
+
+BitListDec(FlagList)
+
+BitListDef(FlagList)
+
+ListDecSoA(Particles, (int, id), (double, mass))
+
+ListDefSoA(Particles, (int, id), (double, mass))
+
+static const List_policy queue_policy = {16, 3, 2, 0};
+
+ListDec(int, QueueList)
+
+ListDefWithPolicy(int, QueueList, &queue_policy)
+
+static const List_policy eager_policy = {4, 2, 0, 1};
+
+ListDec(int, EagerList)
+
+ListDefWithPolicy(int, EagerList, &eager_policy)
+
+static List_arena request_arena;
+
+ListDec(int, ArenaIntList)
+
+ListDefWithAllocator(int, ArenaIntList, list_arena_allocator(&request_arena))
+
+typedef struct {
+    int x;
+    int y;
+} Point;
+
+#define POINT_EQ(a, b) ((a).x == (b).x && (a).y == (b).y)
+
+ListDec(Point, PointList)
+
+ListDefWithEq(Point, PointList, POINT_EQ)
+
+#define SAME_LAST_DIGIT(a, b) ((a) % 10 == (b) % 10)
+
+ListDec(int, DigitList)
+
+ListDefWithEq(int, DigitList, SAME_LAST_DIGIT)
+
+static int parallel_sum;
+
+void add_to_sum(int value) {
+    __atomic_fetch_add(&parallel_sum, value, __ATOMIC_RELAXED);
+}
+
+int last_three_digits(int value) {
+    return value % 1000;
+}
+
+int add_int(int a, int b) {
+    return a + b;
+}
+
+bool is_even(int value) {
+    return value % 2 == 0;
+}
+
 void print_int(int value) {
     printf("%d", value);
 }
 
+void print_int_space(int value) {
+    printf("%d ", value);
+}
+
 int main(int argc, char const *argv[]) {
     IntList *a = create_IntList();
 
@@ -76,6 +203,12 @@ int main(int argc, char const *argv[]) {
     printf("index of 2 in a:%d\n", find_IntList(a, 2));
     printf("end test\n\n");
 
+    //test count
+    printf("test count\n");
+    printf("expect count of 2 in a: 2\n");
+    printf("count of 2 in a: %d\n", count_IntList(a, 2));
+    printf("end test\n\n");
+
     //test pop
     printf("test pop\n");
     printf("a: [1111,234,2,100,1,2,3]\n");
@@ -123,6 +256,10 @@ int main(int argc, char const *argv[]) {
     printf("raw list is :[1,45,0,343,-1,1023,-1]\n");
     printf("list d (from raw list) is: ");
     print_IntList(d, print_int);
+    IntList *from_empty = from_array_IntList(NULL, 0);
+    printf("expect from NULL, 0 size: 0, errno: LIST_OK\n");
+    printf("from NULL, 0 size: %d, errno: %s\n", size_IntList(from_empty), list_errno_str(get_errno_IntList(from_empty)));
+    destroy_IntList(from_empty);
     printf("end test\n\n");
 
     // test replace
@@ -141,6 +278,585 @@ int main(int argc, char const *argv[]) {
     print_IntList(e, print_int);
     printf("end test\n\n");
 
+    // test bulk operations
+    printf("test bulk operations\n");
+    int bulk[] = {7, 8, 9};
+    IntList *k = create_IntList();
+    push_n_IntList(k, 0, 3);
+    append_array_IntList(k, bulk, 3);
+    insert_range_IntList(k, 1, bulk, 2);
+    printf("expect k: [0,7,8,0,0,7,8,9]\nk: ");
+    print_IntList(k, print_int);
+    erase_range_IntList(k, 2, 6);
+    printf("expect k (after erase 2,6): [0,7,8,9]\nk: ");
+    print_IntList(k, print_int);
+    append_array_IntList(k, k->data, 4);
+    printf("expect k (after self-append): [0,7,8,9,0,7,8,9]\nk: ");
+    print_IntList(k, print_int);
+    insert_range_IntList(k, 1, k->data, 3);
+    printf("expect k (after self-insert 1): [0,0,7,8,7,8,9,0,7,8,9]\nk: ");
+    print_IntList(k, print_int);
+    destroy_IntList(k);
+    printf("end test\n\n");
+
+    // test predicate operations
+    printf("test predicate operations\n");
+    IntList *filtered = create_IntList();
+    for (int i = 0; i < 100; i++) {
+        push_IntList(filtered, i);
+    }
+    size_t dropped = remove_if_IntList(filtered, is_even);
+    printf("expect dropped: 50, size: 50, capacity: 128, [0]: 1\n");
+    printf("dropped: %zu, size: %d, capacity: %d, [0]: %d\n", dropped, size_IntList(filtered),
+           capacity_IntList(filtered), get_IntList(filtered, 0));
+    int runs[] = {3, 3, 1, 1, 1, 2, 3, 3};
+    clear_IntList(filtered);
+    append_array_IntList(filtered, runs, 8);
+    dedup_adjacent_IntList(filtered);
+    printf("expect dedup: [3,1,2,3]\ndedup: ");
+    print_IntList(filtered, print_int);
+    unique_IntList(filtered);
+    printf("expect unique: [1,2,3]\nunique: ");
+    print_IntList(filtered, print_int);
+    int mixed[] = {5, 2, 9, 4, 7, 6};
+    clear_IntList(filtered);
+    append_array_IntList(filtered, mixed, 6);
+    int split = partition_IntList(filtered, is_even);
+    printf("expect partition: [2,4,6,5,9,7], split: 3\npartition: ");
+    print_IntList(filtered, print_int);
+    printf("split: %d\n", split);
+    retain_if_IntList(filtered, is_even);
+    printf("expect retain even: [2,4,6]\nretain even: ");
+    print_IntList(filtered, print_int);
+    destroy_IntList(filtered);
+    printf("end test\n\n");
+
+    // test sort and binary search
+    printf("test sort and binary search\n");
+    IntList *m = create_IntList();
+    for (int i = 0; i < 5000; i++) {
+        push_IntList(m, (i * 7919) % 5003 - 2500);
+    }
+    sort_IntList(m);
+    bool sorted = true;
+    for (int i = 1; i < size_IntList(m); i++) {
+        sorted = sorted && get_IntList(m, i - 1) <= get_IntList(m, i);
+    }
+    printf("expect m sorted: 1, first: -2500\n");
+    printf("m sorted: %d, first: %d\n", sorted, first_IntList(m));
+    clear_IntList(m);
+    int odd[] = {1, 3, 5, 7};
+    int even[] = {2, 4, 6};
+    IntList *n = from_array_IntList(even, 3);
+    append_array_IntList(m, odd, 4);
+    merge_sorted_IntList(m, n);
+    insert_sorted_IntList(m, 4);
+    printf("expect m: [1,2,3,4,4,5,6,7]\nm: ");
+    print_IntList(m, print_int);
+    printf("expect lower_bound 4: 3, upper_bound 4: 5, binary_find 8: -1\n");
+    printf("lower_bound 4: %d, upper_bound 4: %d, binary_find 8: %d\n",
+           lower_bound_IntList(m, 4), upper_bound_IntList(m, 4), binary_find_IntList(m, 8));
+    destroy_IntList(m);
+    destroy_IntList(n);
+    BigList *o = create_BigList();
+    for (int i = 0; i < 100; i++) {
+        push_BigList(o, (i * 37) % 100 * 0.25);
+    }
+    sort_BigList(o);
+    printf("expect o (descending) first: 24.75, back: 0.00, binary_find 12.5: 49\n");
+    printf("o first: %.2f, back: %.2f, binary_find 12.5: %td\n",
+           first_BigList(o), back_BigList(o), binary_find_BigList(o, 12.5));
+    destroy_BigList(o);
+    printf("end test\n\n");
+
+    // test heap
+    printf("test heap\n");
+    int pending[] = {42, 7, 19, 3, 25, 11};
+    IntList *jobs = from_array_IntList(pending, 6);
+    heapify_IntList(jobs);
+    heap_push_IntList(jobs, 5);
+    printf("expect top: 3, pop: 3, replace returns: 5, top after replace: 7\n");
+    printf("top: %d, ", heap_top_IntList(jobs));
+    printf("pop: %d, ", heap_pop_IntList(jobs));
+    printf("replace returns: %d, ", heap_replace_IntList(jobs, 30));
+    printf("top after replace: %d\n", heap_top_IntList(jobs));
+    printf("expect drained: 7 11 19 25 30 42 \ndrained: ");
+    while (!empty_IntList(jobs)) {
+        printf("%d ", heap_pop_IntList(jobs));
+    }
+    printf("\n");
+    heap_pop_IntList(jobs);
+    printf("expect pop on empty: LIST_EMPTY\n");
+    printf("pop on empty: %s\n", list_errno_str(get_errno_IntList(jobs)));
+    IntList *candidates = from_array_IntList(pending, 6);
+    IntList *smallest = top_k_IntList(candidates, 3);
+    printf("expect top 3: [3,7,11]\ntop 3: ");
+    print_IntList(smallest, print_int);
+    destroy_IntList(smallest);
+    destroy_IntList(candidates);
+    IntList *no_candidates = create_IntList();
+    IntList *none = top_k_IntList(no_candidates, 3);
+    printf("expect top 3 of empty size: 0\n");
+    printf("top 3 of empty size: %d\n", size_IntList(none));
+    destroy_IntList(none);
+    destroy_IntList(no_candidates);
+    destroy_IntList(jobs);
+    printf("end test\n\n");
+
+    // test hash index
+    printf("test hash index\n");
+    IntList *p = create_IntList();
+    IntListIndex *pi = create_IntListIndex(p);
+    for (int i = 0; i < 10; i++) {
+        push_IntListIndex(pi, i % 5);
+    }
+    remove_at_IntListIndex(pi, 0);
+    set_IntListIndex(pi, 1, 9);
+    replace_IntListIndex(pi, 3, 4);
+    printf("expect p: [1,9,4,4,0,1,2,4,4]\np: ");
+    print_IntList(p, print_int);
+    printf("expect find 4: 2, count 4: 4, contains 3: 0, find 0: 4\n");
+    printf("find 4: %d, count 4: %d, contains 3: %d, find 0: %d\n", find_IntListIndex(pi, 4),
+           count_IntListIndex(pi, 4), contains_IntListIndex(pi, 3), find_IntListIndex(pi, 0));
+    destroy_IntListIndex(pi);
+    destroy_IntList(p);
+    printf("end test\n\n");
+
+    // test view
+    printf("test view\n");
+    printf("list d: [1,45,0,343,-111,1023,-111]\n");
+    IntList_view v = view_IntList(d, 2, 6);
+    printf("expect view 2,6 of d: 0 343 -111 1023 , find 1023: 3\nview: ");
+    view_for_each_IntList(v, print_int_space);
+    printf(", find 1023: %d\n", view_find_IntList(v, 1023));
+    IntList *q = view_to_list_IntList(subview_IntList(v, 1, 3));
+    printf("expect q (subview 1,3 materialized): [343,-111]\nq: ");
+    print_IntList(q, print_int);
+    destroy_IntList(q);
+    printf("end test\n\n");
+
+    // test growth policy
+    printf("test growth policy\n");
+    QueueList *r = create_QueueList();
+    for (int i = 0; i < 100; i++) {
+        push_QueueList(r, i);
+    }
+    printf("expect capacity of r (x1.5 from 16): 121\n");
+    printf("capacity of r: %d\n", capacity_QueueList(r));
+    while (!empty_QueueList(r)) {
+        pop_QueueList(r);
+    }
+    printf("expect capacity of r (no auto-shrink): 121\n");
+    printf("capacity of r: %d\n", capacity_QueueList(r));
+    push_n_QueueList(r, 1, 5);
+    clear_keep_capacity_QueueList(r);
+    printf("expect size of r: 0, capacity of r: 121\n");
+    printf("size of r: %d, capacity of r: %d\n", size_QueueList(r), capacity_QueueList(r));
+    push_n_QueueList(r, 1, 5);
+    shrink_to_fit_QueueList(r);
+    printf("expect capacity of r (shrink to fit): 5\n");
+    printf("capacity of r: %d\n", capacity_QueueList(r));
+    destroy_QueueList(r);
+    EagerList *eager = create_EagerList();
+    for (int i = 0; i < 13; i++) {
+        push_EagerList(eager, i);
+    }
+    pop_EagerList(eager);
+    printf("expect eager size: 12, [11]: 11, capacity >= size: 1\n");
+    printf("eager size: %d, [11]: %d, capacity >= size: %d\n", size_EagerList(eager), get_EagerList(eager, 11),
+           capacity_EagerList(eager) >= size_EagerList(eager));
+    erase_range_EagerList(eager, 4, 9);
+    printf("expect eager after erase 4,9: [0,1,2,3,9,10,11]\neager: ");
+    print_EagerList(eager, print_int);
+    destroy_EagerList(eager);
+    printf("end test\n\n");
+
+    // test custom equality
+    printf("test custom equality\n");
+    PointList *u = create_PointList();
+    for (int i = 0; i < 10; i++) {
+        push_PointList(u, (Point){i, i * i});
+    }
+    printf("expect index of (3, 9): 3, index of (3, 4): -1\n");
+    printf("index of (3, 9): %d, index of (3, 4): %d\n",
+           find_PointList(u, (Point){3, 9}), find_PointList(u, (Point){3, 4}));
+    destroy_PointList(u);
+    DigitList *w = create_DigitList();
+    for (int i = 0; i < 100; i++) {
+        push_DigitList(w, i);
+    }
+    printf("expect count of 7: 10, index of 17: 7\n");
+    printf("count of 7: %d, index of 17: %d\n", count_DigitList(w, 7), find_DigitList(w, 17));
+    destroy_DigitList(w);
+    printf("end test\n\n");
+
+    // test file-backed list
+    printf("test file-backed list\n");
+    IntList *x = create_IntList();
+    for (int i = 0; i < 1000; i++) {
+        push_IntList(x, i * 3);
+    }
+    save_IntList(x, "c_list_test.bin");
+    destroy_IntList(x);
+    IntList_mapped mapped = map_IntList("c_list_test.bin", true);
+    printf("expect mapped count: 1000, mapped[999]: 2997\n");
+    printf("mapped count: %d, mapped[999]: %d\n", mapped.count, mapped.data[999]);
+    mapped.data[0] = -1;
+    unmap_IntList(&mapped);
+    mapped = map_IntList("c_list_test.bin", false);
+    printf("expect mapped[0] after copy-on-write: 0\n");
+    printf("mapped[0] after copy-on-write: %d\n", mapped.data[0]);
+    IntList *x2 = from_array_IntList(raw_list, 7);
+    bool saved = save_IntList(x2, "c_list_test.bin");
+    destroy_IntList(x2);
+    IntList_mapped replaced = map_IntList("c_list_test.bin", false);
+    printf("expect save over mapped file: 1, old mapped[999]: 2997, new count: 7\n");
+    printf("save over mapped file: %d, old mapped[999]: %d, new count: %d\n", saved, mapped.data[999],
+           replaced.count);
+    unmap_IntList(&replaced);
+    unmap_IntList(&mapped);
+    BigList_mapped wrong = map_BigList("c_list_test.bin", false);
+    printf("expect map as double list: LIST_INVALID_FORMAT\n");
+    printf("map as double list: %s\n", wrong.data == NULL ? clean_list_errno() : "mapped");
+    remove("c_list_test.bin");
+    map_IntList("c_list_test.bin", false);
+    printf("expect map missing file: LIST_IO_ERROR\n");
+    printf("map missing file: %s\n", clean_list_errno());
+    printf("end test\n\n");
+
+    // test streaming
+    printf("test streaming\n");
+    FILE *stream = tmpfile();
+    IntList *y = create_IntList();
+    for (int i = 0; i < 300000; i++) {
+        push_IntList(y, i);
+    }
+    write_IntList(y, stream);
+    fwrite(y->data, sizeof(int), 300000, stream);
+    rewind(stream);
+    IntList *z = read_IntList(stream);
+    printf("expect read size: 300000, z[299999]: 299999\n");
+    printf("read size: %d, z[299999]: %d\n", size_IntList(z), get_IntList(z, 299999));
+    printf("expect appended: 300000, size: 600000, z[300001]: 1\n");
+    printf("appended: %d, ", append_from_stream_IntList(z, stream));
+    printf("size: %d, z[300001]: %d\n", size_IntList(z), get_IntList(z, 300001));
+    fclose(stream);
+    destroy_IntList(y);
+    destroy_IntList(z);
+    int block_of_ten[10] = {0};
+    stream = tmpfile();
+    fputs("not a list", stream);
+    rewind(stream);
+    read_IntList(stream);
+    printf("expect read garbage: LIST_INVALID_FORMAT\n");
+    printf("read garbage: %s\n", clean_list_errno());
+    fclose(stream);
+    stream = tmpfile();
+    List_file_header claimed = list_file_header(sizeof(int), 1000000000);
+    fwrite(&claimed, sizeof(claimed), 1, stream);
+    fwrite(block_of_ten, sizeof(int), 10, stream);
+    rewind(stream);
+    read_IntList(stream);
+    printf("expect read short payload: LIST_INVALID_FORMAT\n");
+    printf("read short payload: %s\n", clean_list_errno());
+    fclose(stream);
+    printf("end test\n\n");
+
+    // test concurrent list
+    printf("test concurrent list\n");
+    SharedIntList *shared = create_SharedIntList();
+    for (int i = 0; i < 100; i++) {
+        push_SharedIntList(shared, i);
+    }
+    int *first_slot = at_SharedIntList(shared, 0);
+    int block[200];
+    for (int i = 0; i < 200; i++) {
+        block[i] = 100 + i;
+    }
+    append_array_SharedIntList(shared, block, 200);
+    SharedIntList_batch batch;
+    batch_init_SharedIntList(&batch, shared);
+    for (int i = 300; i < 400; i++) {
+        batch_push_SharedIntList(&batch, i);
+    }
+    batch_flush_SharedIntList(&batch);
+    printf("expect size: 400, [63]: 63, [64]: 64, [399]: 399, first slot unmoved: 1\n");
+    printf("size: %zu, [63]: %d, [64]: %d, [399]: %d, first slot unmoved: %d\n",
+           size_SharedIntList(shared), get_SharedIntList(shared, 63), get_SharedIntList(shared, 64),
+           get_SharedIntList(shared, 399), first_slot == at_SharedIntList(shared, 0));
+    size_t near_full = list_segment_max_capacity(sizeof(int)) - 1;
+    atomic_store(&shared->count, near_full);
+    bool appended = append_array_SharedIntList(shared, block, 2);
+    printf("expect append past capacity: 0 LIST_INVALID_CAPACITY, size unchanged: 1\n");
+    printf("append past capacity: %d %s, size unchanged: %d\n", appended, list_errno_str(get_list_errno()),
+           size_SharedIntList(shared) == near_full);
+    destroy_SharedIntList(shared);
+    printf("end test\n\n");
+
+    // test parallel operations
+    printf("test parallel operations\n");
+    List_pool *pool = list_pool_create(3);
+    IntList *big = create_IntList();
+    for (int i = 0; i < 100000; i++) {
+        push_IntList(big, (i * 7919) % 100000);
+    }
+    IntList *digits = parallel_map_IntList(big, last_three_digits, pool);
+    parallel_for_each_IntList(digits, add_to_sum, pool);
+    printf("expect digits[1]: 919, for_each sum: 49950000, reduce sum: 49950000\n");
+    printf("digits[1]: %d, for_each sum: %d, reduce sum: %d\n", get_IntList(digits, 1), parallel_sum,
+           parallel_reduce_IntList(digits, 0, add_int, pool));
+    parallel_sort_IntList(big, pool);
+    int in_order = 1;
+    for (int i = 0; i < 100000; i++) {
+        in_order &= get_IntList(big, i) == i;
+    }
+    printf("expect sorted: 1, small list reduce: 6\n");
+    IntList *small = create_IntList();
+    push_IntList(small, 1);
+    push_IntList(small, 2);
+    push_IntList(small, 3);
+    printf("sorted: %d, small list reduce: %d\n", in_order, parallel_reduce_IntList(small, 0, add_int, NULL));
+    destroy_IntList(big);
+    destroy_IntList(digits);
+    destroy_IntList(small);
+    list_pool_destroy(pool);
+    printf("end test\n\n");
+
+    // test unchecked access
+    printf("test unchecked access\n");
+    IntList *raw = create_IntList();
+    reserve_IntList(raw, 10);
+    for (int i = 0; i < 10; i++) {
+        push_unchecked_IntList(raw, i);
+    }
+    *at_IntList(raw, 0) = 100;
+    int raw_sum = 0;
+    LIST_FOREACH(int, it, raw) {
+        raw_sum += *it;
+    }
+    printf("expect size: 10, data[9]: 9, sum: 145\n");
+    printf("size: %d, data[9]: %d, sum: %d\n", size_IntList(raw), data_IntList(raw)[9], raw_sum);
+    destroy_IntList(raw);
+    printf("end test\n\n");
+
+    // test segmented list
+    printf("test segmented list\n");
+    IntListSegmented *seg = create_IntListSegmented();
+    push_IntListSegmented(seg, 0);
+    int *seg_first = at_IntListSegmented(seg, 0);
+    for (int i = 1; i < 1000; i++) {
+        push_IntListSegmented(seg, i);
+    }
+    printf("expect size: 1000, [63]: 63, [64]: 64, [999]: 999, capacity: 1984, first unmoved: 1\n");
+    printf("size: %zu, [63]: %d, [64]: %d, [999]: %d, capacity: %zu, first unmoved: %d\n",
+           size_IntListSegmented(seg), get_IntListSegmented(seg, 63), get_IntListSegmented(seg, 64),
+           get_IntListSegmented(seg, 999), capacity_IntListSegmented(seg), seg_first == at_IntListSegmented(seg, 0));
+    IntList *flat = from_segmented_IntList(seg);
+    IntListSegmented *round_trip = to_segmented_IntList(flat);
+    printf("expect flat size: 1000, flat[500]: 500, round trip [999]: 999\n");
+    printf("flat size: %d, flat[500]: %d, round trip [999]: %d\n", size_IntList(flat), get_IntList(flat, 500),
+           get_IntListSegmented(round_trip, 999));
+    destroy_IntList(flat);
+    destroy_IntListSegmented(round_trip);
+    destroy_IntListSegmented(seg);
+    printf("end test\n\n");
+
+    // test small-buffer list
+    printf("test small-buffer list\n");
+    SmallIntList small_list;
+    init_SmallIntList(&small_list);
+    for (int i = 0; i < 8; i++) {
+        push_SmallIntList(&small_list, i);
+    }
+    printf("expect 8 elements inline: 1\n");
+    printf("8 elements inline: %d\n", small_list.data == small_list.inline_data);
+    push_SmallIntList(&small_list, 8);
+    printf("expect 9 elements inline: 0, capacity: 16, [8]: 8\n");
+    printf("9 elements inline: %d, capacity: %d, [8]: %d\n", small_list.data == small_list.inline_data,
+           capacity_SmallIntList(&small_list), get_SmallIntList(&small_list, 8));
+    for (int i = 0; i < 6; i++) {
+        pop_SmallIntList(&small_list);
+    }
+    printf("expect after pops inline: 1, small_list: [0,1,2]\n");
+    printf("after pops inline: %d, small_list: ", small_list.data == small_list.inline_data);
+    print_SmallIntList(&small_list, print_int);
+    free_SmallIntList(&small_list);
+    printf("end test\n\n");
+
+    // test deque
+    printf("test deque\n");
+    IntDeque *dq = create_IntDeque();
+    for (int i = 1; i <= 10; i++) {
+        push_back_IntDeque(dq, i);
+    }
+    push_front_IntDeque(dq, 0);
+    push_front_IntDeque(dq, -1);
+    printf("expect dq: [-1,0,1,2,3,4,5,6,7,8,9,10]\ndq: ");
+    print_IntDeque(dq, print_int);
+    printf("expect pop_front: -1, pop_back: 10, get(3): 3, capacity: 16\n");
+    printf("pop_front: %d, pop_back: %d, ", pop_front_IntDeque(dq), pop_back_IntDeque(dq));
+    printf("get(3): %d, capacity: %zu\n", get_IntDeque(dq, 3), capacity_IntDeque(dq));
+    for (int i = 0; i < 1000; i++) {
+        push_back_IntDeque(dq, i);
+        pop_front_IntDeque(dq);
+    }
+    printf("expect after 1000 rotations front: 990, back: 999, capacity: 16\n");
+    printf("after 1000 rotations front: %d, back: %d, capacity: %zu\n",
+           front_IntDeque(dq), back_IntDeque(dq), capacity_IntDeque(dq));
+    clear_IntDeque(dq);
+    pop_front_IntDeque(dq);
+    printf("expect pop_front on empty: LIST_EMPTY\n");
+    printf("pop_front on empty: %s\n", list_errno_str(get_errno_IntDeque(dq)));
+    destroy_IntDeque(dq);
+    printf("end test\n\n");
+
+    // test release and adopt
+    printf("test release and adopt\n");
+    IntList *producer = create_IntList();
+    for (int i = 0; i < 100; i++) {
+        push_IntList(producer, i);
+    }
+    int *producer_data = producer->data;
+    size_t released_len = 0;
+    int *released = release_IntList(producer, &released_len);
+    printf("expect released len: 100, same buffer: 1, released[99]: 99, list size after: 0\n");
+    printf("released len: %zu, same buffer: %d, released[99]: %d, list size after: %d\n", released_len,
+           released == producer_data, released[99], size_IntList(producer));
+    IntList *adopted = adopt_IntList(released, released_len, 128);
+    push_IntList(adopted, 100);
+    printf("expect adopted same buffer: 1, size: 101, capacity: 128, [100]: 100\n");
+    printf("adopted same buffer: %d, size: %d, capacity: %d, [100]: %d\n", adopted->data == producer_data,
+           size_IntList(adopted), capacity_IntList(adopted), get_IntList(adopted, 100));
+    adopt_IntList(NULL, 0, 16);
+    printf("expect adopt NULL buffer: LIST_INVALID_RAW_ARRAY\n");
+    printf("adopt NULL buffer: %s\n", list_errno_str(get_list_errno()));
+    destroy_IntList(adopted);
+    destroy_IntList(producer);
+    SmallIntList inline_list;
+    init_SmallIntList(&inline_list);
+    push_SmallIntList(&inline_list, 7);
+    int *copied = release_SmallIntList(&inline_list, &released_len);
+    printf("expect inline release copied: 1, len: 1, [0]: 7\n");
+    printf("inline release copied: %d, len: %zu, [0]: %d\n", copied != inline_list.inline_data, released_len, copied[0]);
+    free(copied);
+    free_SmallIntList(&inline_list);
+    printf("end test\n\n");
+
+    // test bit list
+    printf("test bit list\n");
+    FlagList *multiples_of_3 = create_FlagList();
+    FlagList *multiples_of_5 = create_FlagList();
+    for (int i = 0; i < 1000; i++) {
+        push_FlagList(multiples_of_3, i % 3 == 0);
+        push_FlagList(multiples_of_5, i % 5 == 0);
+    }
+    printf("expect size: 1000, capacity: 1024, set: 334, clear: 666, [9]: 1\n");
+    printf("size: %zu, capacity: %zu, set: %zu, clear: %zu, [9]: %d\n", size_FlagList(multiples_of_3),
+           capacity_FlagList(multiples_of_3), count_FlagList(multiples_of_3, true),
+           count_FlagList(multiples_of_3, false), get_FlagList(multiples_of_3, 9));
+    and_FlagList(multiples_of_3, multiples_of_5);
+    printf("expect and set: 67, first set: 0, next set after 1: 15\n");
+    printf("and set: %zu, first set: %td, next set after 1: %td\n", count_FlagList(multiples_of_3, true),
+           find_first_set_FlagList(multiples_of_3), find_next_set_FlagList(multiples_of_3, 1));
+    set_FlagList(multiples_of_3, 0, false);
+    xor_FlagList(multiples_of_3, multiples_of_5);
+    or_FlagList(multiples_of_5, multiples_of_3);
+    printf("expect xor first set: 0, or set: 200\n");
+    printf("xor first set: %td, or set: %zu\n", find_first_set_FlagList(multiples_of_3),
+           count_FlagList(multiples_of_5, true));
+    FlagList *short_flags = create_FlagList();
+    push_n_FlagList(short_flags, true, 3);
+    push_FlagList(short_flags, false);
+    printf("expect short_flags: [1,1,1,0], first clear: 3\nshort_flags: ");
+    print_FlagList(short_flags);
+    printf("first clear: %td\n", find_FlagList(short_flags, false));
+    and_FlagList(short_flags, multiples_of_5);
+    printf("expect and with different sizes: LIST_OUT_OF_RANGE\n");
+    printf("and with different sizes: %s\n", list_errno_str(get_errno_FlagList(short_flags)));
+    destroy_FlagList(short_flags);
+    destroy_FlagList(multiples_of_5);
+    destroy_FlagList(multiples_of_3);
+    printf("end test\n\n");
+
+    // test packed list
+    printf("test packed list\n");
+    IdList *ids = create_IdList();
+    for (uint32_t i = 0; i < 10000; i++) {
+        push_IdList(ids, 1000000 + i * 3 + i % 2);
+    }
+    IdListPacked *packed_ids = to_packed_IdList(ids);
+    printf("expect size: 10000, [0]: 1000000, [9999]: 1029998, under a quarter of the raw bytes: 1\n");
+    printf("size: %zu, [0]: %u, [9999]: %u, under a quarter of the raw bytes: %d\n", size_IdListPacked(packed_ids),
+           get_IdListPacked(packed_ids, 0), get_IdListPacked(packed_ids, 9999),
+           bytes_IdListPacked(packed_ids) * 4 < sizeof(uint32_t) * 10000);
+    printf("expect lower_bound 1000301: 101, lower_bound past end: 10000\n");
+    printf("lower_bound 1000301: %zu, lower_bound past end: %zu\n", lower_bound_IdListPacked(packed_ids, 1000301),
+           lower_bound_IdListPacked(packed_ids, 2000000));
+    push_IdListPacked(packed_ids, 7);
+    IdList *unpacked = from_packed_IdList(packed_ids);
+    printf("expect unpacked size: 10001, [5000]: 1015000, back: 7\n");
+    printf("unpacked size: %d, [5000]: %u, back: %u\n", size_IdList(unpacked), get_IdList(unpacked, 5000),
+           back_IdList(unpacked));
+    destroy_IdList(unpacked);
+    destroy_IdListPacked(packed_ids);
+    destroy_IdList(ids);
+    printf("end test\n\n");
+
+    // test struct-of-arrays list
+    printf("test struct-of-arrays list\n");
+    Particles *particles = create_Particles();
+    for (int i = 0; i < 100; i++) {
+        push_Particles(particles, (Particles_row){i, i * 0.5});
+    }
+    double total_mass = 0;
+    for (size_t i = 0; i < particles->count; i++) {
+        total_mass += particles->mass[i];
+    }
+    printf("expect size: 100, total mass: 2475.0, [10]: (10, 5.0)\n");
+    Particles_row row = get_Particles(particles, 10);
+    printf("size: %zu, total mass: %.1f, [10]: (%d, %.1f)\n", size_Particles(particles), total_mass, row.id, row.mass);
+    insert_Particles(particles, 0, (Particles_row){-1, 0.0});
+    remove_at_Particles(particles, 50);
+    row = pop_Particles(particles);
+    printf("expect ids after insert/remove: -1 0 50, popped: 99, size: 99\n");
+    printf("ids after insert/remove: %d %d %d, popped: %d, size: %zu\n", particles->id[0], particles->id[1],
+           particles->id[50], row.id, size_Particles(particles));
+    destroy_Particles(particles);
+    printf("end test\n\n");
+
+    // test arena allocator
+    printf("test arena allocator\n");
+    list_arena_init(&request_arena, 0);
+    ArenaIntList *f = create_ArenaIntList();
+    ArenaIntList *g = create_ArenaIntList();
+    for (int i = 0; i < 100; i++) {
+        push_ArenaIntList(f, i);
+        push_ArenaIntList(g, i * 2);
+    }
+    printf("expect size of f: 100, g[99]: 198\n");
+    printf("size of f: %d, g[99]: %d\n", size_ArenaIntList(f), get_ArenaIntList(g, 99));
+    list_arena_reset(&request_arena);
+    f = create_ArenaIntList();
+    push_ArenaIntList(f, 7);
+    printf("expect f (after reset): [7]\nf: ");
+    print_ArenaIntList(f, print_int);
+    list_arena_destroy(&request_arena);
+    printf("end test\n\n");
+
+    // test 64-bit sizes
+    printf("test 64-bit list\n");
+    BigList *h = create_BigList();
+    for (int i = 0; i < 1000; i++) {
+        push_BigList(h, i * 0.5);
+    }
+    printf("expect size of h: 1000, index of 250.0: 500\n");
+    printf("size of h: %zu, index of 250.0: %td\n", size_BigList(h), find_BigList(h, 250.0));
+    printf("expect resize beyond limit fails: LIST_INVALID_CAPACITY\n");
+    resize_BigList(h, SIZE_MAX);
+    printf("resize beyond limit: %s\n", list_errno_str(get_errno_BigList(h)));
+    destroy_BigList(h);
+    printf("end test\n\n");
+
     destroy_IntList(a);
     destroy_IntList(b);
     destroy_IntList(c);
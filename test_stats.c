@@ -0,0 +1,49 @@
+#include "c_list.h"
+#include<stdio.h>
+
+LIST_INIT
+
+ListDec(int, IntList)
+
+ListDef(int, IntList)
+
+ListDecSBO(int, SmallIntList, 8)
+
+ListDef(int, SmallIntList)
+
+int main(void) {
+    // test stats
+    printf("test stats\n");
+    reset_stats_IntList();
+    IntList *t = create_IntList();
+    for (int i = 0; i < 20; i++) {
+        push_IntList(t, i);
+    }
+    insert_IntList(t, 0, -1);
+    remove_at_IntList(t, 0);
+    find_IntList(t, 19);
+    List_stats stats = get_stats_IntList();
+    printf("expect reallocations: 3, element_shifts: 40, find_scans: 1\n");
+    printf("reallocations: %llu, element_shifts: %llu, find_scans: %llu\n",
+           stats.reallocations, stats.element_shifts, stats.find_scans);
+    destroy_IntList(t);
+    dump_stats_IntList(stdout);
+    printf("end test\n\n");
+
+    // test small-buffer stats
+    printf("test small-buffer stats\n");
+    SmallIntList small_list;
+    init_SmallIntList(&small_list);
+    reset_stats_SmallIntList();
+    for (int i = 0; i < 8; i++) {
+        push_SmallIntList(&small_list, i);
+    }
+    printf("expect 8 elements reallocations: 0\n");
+    printf("8 elements reallocations: %llu\n", get_stats_SmallIntList().reallocations);
+    push_SmallIntList(&small_list, 8);
+    printf("expect 9 elements reallocations: 1\n");
+    printf("9 elements reallocations: %llu\n", get_stats_SmallIntList().reallocations);
+    free_SmallIntList(&small_list);
+    printf("end test\n\n");
+    return 0;
+}